@@ -0,0 +1,201 @@
+// Allocations and time per hop of a chain of synchronized steps (parse, validate, persist), each hop posted to a
+// queue executor storing std::function, as thread pools usually do:
+//   - rewrapped: each step posts the next one, wrapped again with synchronized() and capturing the intermediate result;
+//   - chain: the steps are built once with TaskSynchronizer::chain(), each message being posted with Chain::post().
+// Allocations are counted by replacing the global operator new.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <new>
+#include <string>
+#include <utility>
+
+#include <tasksync/tasksync.hpp>
+#include <tasksync/chain.hpp>
+
+namespace {
+
+    std::atomic<uint64_t> allocations{ 0 };
+
+}
+
+// GCC reports the memory of the inlined replacements below as mismatched, they do match.
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new( std::size_t size )
+{
+    allocations.fetch_add( 1, std::memory_order_relaxed );
+    if( auto* memory = std::malloc( std::max<std::size_t>( size, 1 ) ) )
+        return memory;
+    throw std::bad_alloc{};
+}
+
+void operator delete( void* memory ) noexcept { std::free( memory ); }
+void operator delete( void* memory, std::size_t ) noexcept { std::free( memory ); }
+
+namespace chain_hops {
+
+    using tasksync::TaskSynchronizer;
+    using clock = std::chrono::steady_clock;
+
+    namespace {
+
+        struct Options
+        {
+            int64_t messages = 1'000'000;
+            std::size_t payload = 64; ///< Bytes of each message, past the small string optimization by default.
+        };
+
+        constexpr int64_t hops_per_message = 3;
+
+        /** Executor queuing tasks as std::function, executed in order by drain() on the calling thread. */
+        class QueueExecutor
+        {
+        public:
+            void post( std::function<void()> task ) { m_tasks.push_back( std::move( task ) ); }
+
+            void drain()
+            {
+                while( !m_tasks.empty() )
+                {
+                    auto task = std::move( m_tasks.front() );
+                    m_tasks.pop_front();
+                    task();
+                }
+            }
+
+        private:
+            std::deque<std::function<void()>> m_tasks;
+        };
+
+        /// The steps of the chain, the same in both modes.
+        struct Record { std::string text; int64_t checksum; };
+
+        Record parse( std::string message ) { return { std::move( message ), 0 }; }
+
+        Record validate( Record record )
+        {
+            for( const char character : record.text )
+                record.checksum += character;
+            return record;
+        }
+
+        struct Store
+        {
+            int64_t checksum = 0;
+            void persist( const Record& record ) { checksum += record.checksum; }
+        };
+
+        struct Measure
+        {
+            uint64_t allocations;
+            clock::duration duration;
+            int64_t checksum;
+        };
+
+        template< class PostMessage >
+        Measure measure( const Options& options, QueueExecutor& executor, Store& store, PostMessage&& post_message )
+        {
+            const std::string message( options.payload, 'x' );
+            const auto allocations_before = allocations.load();
+            const auto begin = clock::now();
+            for( int64_t index = 0; index < options.messages; ++index )
+            {
+                post_message( message );
+                executor.drain();
+            }
+            return { allocations.load() - allocations_before, clock::now() - begin, store.checksum };
+        }
+
+        Measure measure_rewrapped( const Options& options )
+        {
+            TaskSynchronizer task_sync;
+            QueueExecutor executor;
+            Store store;
+            return measure( options, executor, store, [&]( const std::string& message ) {
+                executor.post( task_sync.synchronized( [ &, message ]() mutable {
+                    auto parsed = parse( std::move( message ) );
+                    executor.post( task_sync.synchronized( [ &, parsed = std::move( parsed ) ]() mutable {
+                        auto validated = validate( std::move( parsed ) );
+                        executor.post( task_sync.synchronized( [ &, validated = std::move( validated ) ] {
+                            store.persist( validated );
+                        } ) );
+                    } ) );
+                } ) );
+            } );
+        }
+
+        Measure measure_chain( const Options& options )
+        {
+            TaskSynchronizer task_sync;
+            QueueExecutor executor;
+            Store store;
+            const auto chain = task_sync.chain( parse )
+                .then( validate )
+                .then( [&]( const Record& record ) { store.persist( record ); } );
+            const auto post = [&]( auto task ) { executor.post( std::move( task ) ); };
+            return measure( options, executor, store, [&]( const std::string& message ) {
+                chain.post( post, message );
+            } );
+        }
+
+        void print( const char* mode, const Options& options, const Measure& measure )
+        {
+            const auto hops = static_cast<double>( options.messages * hops_per_message );
+            std::printf( "%-12s %8.2f allocations/hop %8.1f ns/hop   (checksum %lld)\n", mode,
+                         static_cast<double>( measure.allocations ) / hops,
+                         static_cast<double>( std::chrono::duration_cast<std::chrono::nanoseconds>( measure.duration ).count() ) / hops,
+                         static_cast<long long>( measure.checksum ) );
+        }
+
+        Options parse_options( int argc, char* argv[] )
+        {
+            Options options;
+            for( int index = 1; index < argc; ++index )
+            {
+                const std::string argument = argv[ index ];
+                const char* value = index + 1 < argc ? argv[ index + 1 ] : nullptr;
+                if( argument == "--help" || !value )
+                {
+                    std::printf( "usage: %s [--messages N] [--payload BYTES]\n", argv[ 0 ] );
+                    std::exit( argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE );
+                }
+
+                const auto integer = [&] { return std::max( 0ll, std::strtoll( value, nullptr, 10 ) ); };
+                if( argument == "--messages" )
+                    options.messages = std::max( 1ll, integer() );
+                else if( argument == "--payload" )
+                    options.payload = static_cast<std::size_t>( integer() );
+                else
+                {
+                    std::fprintf( stderr, "unknown option: %s\n", argument.c_str() );
+                    std::exit( EXIT_FAILURE );
+                }
+                ++index;
+            }
+            return options;
+        }
+
+        void run( const Options& options )
+        {
+            std::printf( "tasksync-chain-hops: %lld messages of %zu bytes, %lld hops each\n",
+                         static_cast<long long>( options.messages ), options.payload, static_cast<long long>( hops_per_message ) );
+            print( "rewrapped", options, measure_rewrapped( options ) );
+            print( "chain", options, measure_chain( options ) );
+        }
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    chain_hops::run( chain_hops::parse_options( argc, argv ) );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,451 @@
+// Load simulation of a service built on TaskSynchronizer.
+//
+// A population of actors, each owning a synchronizer, receives events: driver threads wrap a callback
+// with the synchronizer of a random actor and post it to a thread pool. Meanwhile a churn thread
+// recycles actors (reset() of their synchronizer) and replaces others (destruction, which joins).
+// Reports the throughput of callbacks, their latency from posting to completion, the latency of
+// destructions and resets, and the memory used.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#   include <sys/resource.h>
+#   include <unistd.h>
+#endif
+
+#include <tasksync/tasksync.hpp>
+#include <tasksync/histogram.hpp>
+
+namespace loadsim {
+
+    using tasksync::TaskSynchronizer;
+    using tasksync::DurationHistogram;
+    using clock = std::chrono::steady_clock;
+
+    namespace {
+
+        struct Options
+        {
+            std::size_t objects = 100'000;
+            unsigned workers = std::max( std::thread::hardware_concurrency(), 2u );
+            unsigned drivers = 2;
+            int64_t events_per_second = 200'000; // Zero: as many as the pool accepts.
+            double seconds = 5.0;
+            int64_t churn_per_second = 20'000;
+            int recycle_percent = 50;
+            int64_t work_ns = 500;
+            std::size_t queue_capacity = 4096;
+            uint64_t seed = std::random_device{}();
+        };
+
+        /** Busy work standing for the processing of an event. */
+        void spin_for( std::chrono::nanoseconds duration )
+        {
+            const auto end = clock::now() + duration;
+            while( clock::now() < end ) {}
+        }
+
+        /** Fixed set of worker threads executing posted callbacks in order, blocking posters when full. */
+        class ThreadPool
+        {
+        public:
+            ThreadPool( unsigned workers, std::size_t capacity, std::function<void()> on_worker_exit )
+                : m_capacity( capacity )
+            {
+                for( unsigned index = 0; index < workers; ++index )
+                {
+                    m_threads.emplace_back( [ this, on_worker_exit ] {
+                        work();
+                        on_worker_exit();
+                    } );
+                }
+            }
+
+            ~ThreadPool()
+            {
+                {
+                    std::scoped_lock lock{ m_mutex };
+                    m_stopping = true;
+                }
+                m_not_empty.notify_all();
+                for( auto& thread : m_threads )
+                    thread.join();
+            }
+
+            void post( std::function<void()> callback )
+            {
+                {
+                    std::unique_lock lock{ m_mutex };
+                    m_not_full.wait( lock, [&]{ return m_queue.size() < m_capacity; } );
+                    m_queue.push_back( std::move( callback ) );
+                }
+                m_not_empty.notify_one();
+            }
+
+        private:
+            const std::size_t m_capacity;
+            std::mutex m_mutex;
+            std::condition_variable m_not_empty;
+            std::condition_variable m_not_full;
+            std::deque<std::function<void()>> m_queue;
+            bool m_stopping = false;
+            std::vector<std::thread> m_threads; // Last: started once everything else is initialized.
+
+            void work()
+            {
+                while( true )
+                {
+                    std::function<void()> callback;
+                    {
+                        std::unique_lock lock{ m_mutex };
+                        m_not_empty.wait( lock, [&]{ return m_stopping || !m_queue.empty(); } );
+                        if( m_queue.empty() )
+                            return; // Stopping and drained.
+                        callback = std::move( m_queue.front() );
+                        m_queue.pop_front();
+                    }
+                    m_not_full.notify_one();
+                    callback();
+                }
+            }
+        };
+
+        /** Measurements of one worker thread, merged at the end. */
+        struct WorkerMeasures
+        {
+            int64_t executed = 0;
+            DurationHistogram latencies;
+        };
+
+        thread_local std::unique_ptr<WorkerMeasures> this_worker_measures;
+
+        /** An object of the simulated service, its state only touched by its synchronized callbacks. */
+        class Actor
+        {
+        public:
+            ~Actor()
+            {
+                // Callbacks still queued for this actor will be skipped, running ones are waited for.
+                m_task_sync.join_tasks();
+            }
+
+            void recycle()
+            {
+                m_task_sync.reset();
+                m_handled_events = 0;
+            }
+
+            std::function<void()> make_callback( std::chrono::nanoseconds work )
+            {
+                return m_task_sync.synchronized( [ this, work, posted = clock::now() ] {
+                    spin_for( work );
+                    ++m_handled_events;
+                    if( !this_worker_measures )
+                        this_worker_measures = std::make_unique<WorkerMeasures>();
+                    auto& measures = *this_worker_measures;
+                    ++measures.executed;
+                    measures.latencies.record( clock::now() - posted );
+                } );
+            }
+
+        private:
+            std::atomic<int64_t> m_handled_events{ 0 };
+            std::array<char, 48> m_payload{};
+            TaskSynchronizer m_task_sync;
+        };
+
+        /** Actors and the lock protecting the replacement of each of them. */
+        class Population
+        {
+        public:
+            explicit Population( std::size_t size ) : m_slots( size )
+            {
+                for( auto& slot : m_slots )
+                    slot.actor = std::make_unique<Actor>();
+            }
+
+            std::size_t size() const { return m_slots.size(); }
+
+            std::function<void()> make_callback( std::size_t index, std::chrono::nanoseconds work )
+            {
+                auto& slot = m_slots[ index ];
+                std::scoped_lock lock{ slot.mutex };
+                return slot.actor->make_callback( work );
+            }
+
+            void recycle( std::size_t index )
+            {
+                auto& slot = m_slots[ index ];
+                std::scoped_lock lock{ slot.mutex };
+                slot.actor->recycle();
+            }
+
+            /** @return The replaced actor, to be destroyed by the caller outside of the slot lock. */
+            std::unique_ptr<Actor> replace( std::size_t index )
+            {
+                auto actor = std::make_unique<Actor>();
+                auto& slot = m_slots[ index ];
+                std::scoped_lock lock{ slot.mutex };
+                slot.actor.swap( actor );
+                return actor;
+            }
+
+        private:
+            struct Slot
+            {
+                std::mutex mutex;
+                std::unique_ptr<Actor> actor;
+            };
+
+            std::vector<Slot> m_slots;
+        };
+
+        struct ChurnMeasures
+        {
+            DurationHistogram destructions;
+            DurationHistogram resets;
+        };
+
+        void churn( Population& population, const Options& options, const std::atomic<bool>& stop, ChurnMeasures& measures )
+        {
+            std::mt19937_64 random{ options.seed ^ 0x9e3779b97f4a7c15ull };
+            std::uniform_int_distribution<std::size_t> pick{ 0, population.size() - 1 };
+            std::uniform_int_distribution<int> percent{ 0, 99 };
+
+            // Pace the churn in millisecond ticks.
+            constexpr auto tick = std::chrono::milliseconds{ 1 };
+            const auto begin = clock::now();
+            int64_t churned = 0;
+            while( !stop.load( std::memory_order_relaxed ) )
+            {
+                const std::chrono::duration<double> elapsed = clock::now() - begin;
+                const auto due = static_cast<int64_t>( elapsed.count() * static_cast<double>( options.churn_per_second ) );
+                for( ; churned < due && !stop.load( std::memory_order_relaxed ); ++churned )
+                {
+                    const auto index = pick( random );
+                    if( percent( random ) < options.recycle_percent )
+                    {
+                        const auto reset_begin = clock::now();
+                        population.recycle( index );
+                        measures.resets.record( clock::now() - reset_begin );
+                    }
+                    else
+                    {
+                        auto replaced = population.replace( index );
+                        const auto destruction_begin = clock::now();
+                        replaced.reset();
+                        measures.destructions.record( clock::now() - destruction_begin );
+                    }
+                }
+                std::this_thread::sleep_for( tick );
+            }
+        }
+
+        void drive( Population& population, ThreadPool& pool, const Options& options, unsigned driver_index,
+                    const std::atomic<bool>& stop, std::atomic<int64_t>& posted )
+        {
+            std::mt19937_64 random{ options.seed + driver_index };
+            std::uniform_int_distribution<std::size_t> pick{ 0, population.size() - 1 };
+            const std::chrono::nanoseconds work{ options.work_ns };
+            const auto rate = static_cast<double>( options.events_per_second ) / options.drivers;
+
+            const auto begin = clock::now();
+            int64_t count = 0;
+            while( !stop.load( std::memory_order_relaxed ) )
+            {
+                if( rate > 0 )
+                {
+                    const std::chrono::duration<double> elapsed = clock::now() - begin;
+                    if( static_cast<double>( count ) >= elapsed.count() * rate )
+                    {
+                        std::this_thread::sleep_for( std::chrono::microseconds{ 100 } );
+                        continue;
+                    }
+                }
+                pool.post( population.make_callback( pick( random ), work ) );
+                ++count;
+            }
+            posted += count;
+        }
+
+        /** @return Resident memory of this process in bytes, zero if unknown. */
+        int64_t resident_memory()
+        {
+#if defined(__linux__)
+            if( auto* statm = std::fopen( "/proc/self/statm", "r" ) )
+            {
+                long long size = 0;
+                long long resident = 0;
+                const auto read = std::fscanf( statm, "%lld %lld", &size, &resident );
+                std::fclose( statm );
+                if( read == 2 )
+                    return resident * sysconf( _SC_PAGESIZE );
+            }
+#endif
+            return 0;
+        }
+
+        /** @return Peak resident memory of this process in bytes, zero if unknown. */
+        int64_t peak_resident_memory()
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            rusage usage{};
+            if( getrusage( RUSAGE_SELF, &usage ) == 0 )
+            {
+#   if defined(__APPLE__)
+                return usage.ru_maxrss; // Bytes.
+#   else
+                return usage.ru_maxrss * int64_t{ 1024 }; // Kilobytes.
+#   endif
+            }
+#endif
+            return 0;
+        }
+
+        double microseconds( std::chrono::nanoseconds duration )
+        {
+            return static_cast<double>( duration.count() ) / 1000.0;
+        }
+
+        void print_latencies( const char* name, const DurationHistogram& histogram )
+        {
+            std::printf( "%-24s %10lld  p50 %9.1fus  p99 %9.1fus  max %9.1fus\n", name,
+                         static_cast<long long>( histogram.count() ), microseconds( histogram.p50() ),
+                         microseconds( histogram.p99() ), microseconds( histogram.max() ) );
+        }
+
+        void print_memory( const char* name, int64_t bytes )
+        {
+            std::printf( "%-24s %10.1f MiB\n", name, static_cast<double>( bytes ) / ( 1024.0 * 1024.0 ) );
+        }
+
+        void run( const Options& options )
+        {
+            const auto memory_before = resident_memory();
+
+            auto population = std::make_unique<Population>( options.objects );
+            const auto memory_populated = resident_memory();
+
+            std::mutex measures_mutex;
+            WorkerMeasures callbacks;
+            ChurnMeasures churn_measures;
+            std::atomic<int64_t> posted{ 0 };
+            std::atomic<bool> stop{ false };
+
+            const auto begin = clock::now();
+            std::chrono::duration<double> elapsed{};
+            int64_t memory_loaded = 0;
+            {
+                auto merge_worker_measures = [&] {
+                    if( !this_worker_measures )
+                        return;
+                    std::scoped_lock lock{ measures_mutex };
+                    callbacks.executed += this_worker_measures->executed;
+                    callbacks.latencies.merge( this_worker_measures->latencies );
+                    this_worker_measures.reset();
+                };
+                ThreadPool pool{ options.workers, options.queue_capacity, merge_worker_measures };
+
+                std::vector<std::thread> threads;
+                for( unsigned index = 0; index < options.drivers; ++index )
+                    threads.emplace_back( [ &, index ] { drive( *population, pool, options, index, stop, posted ); } );
+                threads.emplace_back( [&] { churn( *population, options, stop, churn_measures ); } );
+
+                std::this_thread::sleep_for( std::chrono::duration<double>{ options.seconds } );
+                memory_loaded = resident_memory();
+                stop = true;
+                for( auto& thread : threads )
+                    thread.join();
+                elapsed = clock::now() - begin;
+            } // Drains the queued callbacks.
+
+            const auto teardown_begin = clock::now();
+            population.reset();
+            const auto teardown = clock::now() - teardown_begin;
+
+            const auto executed = callbacks.executed;
+            const auto skipped = posted.load() - executed;
+            std::printf( "tasksync-loadsim: %zu objects, %u workers, %u drivers at %lld events/s, %.2fs, churn %lld/s (%d%% recycled), work %lldns, seed %llu\n",
+                         options.objects, options.workers, options.drivers,
+                         static_cast<long long>( options.events_per_second ), elapsed.count(),
+                         static_cast<long long>( options.churn_per_second ), options.recycle_percent,
+                         static_cast<long long>( options.work_ns ), static_cast<unsigned long long>( options.seed ) );
+            std::printf( "%-24s %10.0f /s\n", "tasks", static_cast<double>( executed ) / elapsed.count() );
+            std::printf( "%-24s %10lld executed, %lld skipped by joins\n", "callbacks",
+                         static_cast<long long>( executed ), static_cast<long long>( skipped ) );
+            print_latencies( "callback latency", callbacks.latencies );
+            print_latencies( "destructor latency", churn_measures.destructions );
+            print_latencies( "reset latency", churn_measures.resets );
+            std::printf( "%-24s %10.1f ms\n", "teardown", std::chrono::duration<double, std::milli>{ teardown }.count() );
+            print_memory( "rss of population", memory_populated - memory_before );
+            print_memory( "rss under load", memory_loaded );
+            print_memory( "rss peak", peak_resident_memory() );
+        }
+
+        Options parse_options( int argc, char* argv[] )
+        {
+            Options options;
+            for( int index = 1; index < argc; ++index )
+            {
+                const std::string argument = argv[ index ];
+                const char* value = index + 1 < argc ? argv[ index + 1 ] : nullptr;
+                if( argument == "--help" || !value )
+                {
+                    std::printf( "usage: %s [--objects N] [--workers N] [--drivers N] [--rate N/s] [--seconds S] [--churn N/s]"
+                                 " [--recycle PERCENT] [--work NS] [--queue N] [--seed N]\n", argv[ 0 ] );
+                    std::exit( argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE );
+                }
+
+                const auto integer = [&] { return std::max( 0ll, std::strtoll( value, nullptr, 10 ) ); };
+                if( argument == "--objects" )
+                    options.objects = static_cast<std::size_t>( std::max( 1ll, integer() ) );
+                else if( argument == "--workers" )
+                    options.workers = static_cast<unsigned>( std::max( 1ll, integer() ) );
+                else if( argument == "--drivers" )
+                    options.drivers = static_cast<unsigned>( std::max( 1ll, integer() ) );
+                else if( argument == "--rate" )
+                    options.events_per_second = integer();
+                else if( argument == "--seconds" )
+                    options.seconds = std::strtod( value, nullptr );
+                else if( argument == "--churn" )
+                    options.churn_per_second = integer();
+                else if( argument == "--recycle" )
+                    options.recycle_percent = static_cast<int>( std::min( 100ll, integer() ) );
+                else if( argument == "--work" )
+                    options.work_ns = integer();
+                else if( argument == "--queue" )
+                    options.queue_capacity = static_cast<std::size_t>( std::max( 1ll, integer() ) );
+                else if( argument == "--seed" )
+                    options.seed = std::strtoull( value, nullptr, 10 );
+                else
+                {
+                    std::fprintf( stderr, "unknown option: %s\n", argument.c_str() );
+                    std::exit( EXIT_FAILURE );
+                }
+                ++index;
+            }
+            return options;
+        }
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    loadsim::run( loadsim::parse_options( argc, argv ) );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,262 @@
+// Throughput and peak memory of three stages (decode, transform, sink), each owned by an object with its own
+// synchronizer and executed by its own thread, a producer pushing messages as fast as it can:
+//   - posted: each stage posts the next one, wrapped with synchronized(), to the unbounded queue of a thread;
+//   - pipeline: the stages are connected by tasksync::pipeline(), its bounded queues holding the producer back.
+// Memory is measured by replacing the global operator new, as the peak of the bytes allocated and not freed yet.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <malloc.h>
+
+#include <tasksync/tasksync.hpp>
+#include <tasksync/pipeline.hpp>
+
+namespace {
+
+    std::atomic<int64_t> allocated_bytes{ 0 };
+    std::atomic<int64_t> peak_allocated_bytes{ 0 };
+
+}
+
+// GCC reports the memory of the inlined replacements below as mismatched, they do match.
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new( std::size_t size )
+{
+    if( auto* memory = std::malloc( std::max<std::size_t>( size, 1 ) ) )
+    {
+        const auto bytes = allocated_bytes.fetch_add( static_cast<int64_t>( ::malloc_usable_size( memory ) ), std::memory_order_relaxed )
+                         + static_cast<int64_t>( ::malloc_usable_size( memory ) );
+        auto peak = peak_allocated_bytes.load( std::memory_order_relaxed );
+        while( bytes > peak && !peak_allocated_bytes.compare_exchange_weak( peak, bytes, std::memory_order_relaxed ) )
+        {
+        }
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete( void* memory ) noexcept
+{
+    if( memory )
+        allocated_bytes.fetch_sub( static_cast<int64_t>( ::malloc_usable_size( memory ) ), std::memory_order_relaxed );
+    std::free( memory );
+}
+
+void operator delete( void* memory, std::size_t ) noexcept { operator delete( memory ); }
+
+namespace pipeline_bench {
+
+    using tasksync::TaskSynchronizer;
+    using clock = std::chrono::steady_clock;
+
+    namespace {
+
+        struct Options
+        {
+            int64_t messages = 1'000'000;
+            std::size_t payload = 256; ///< Bytes of each message.
+            std::size_t capacity = 1024; ///< Capacity of the queues of the pipeline.
+        };
+
+        /// The stages, the same in both modes.
+        struct Record { std::string text; int64_t checksum; };
+
+        Record decode( std::string message ) { return { std::move( message ), 0 }; }
+
+        Record transform( Record record )
+        {
+            for( const char character : record.text )
+                record.checksum += character;
+            return record;
+        }
+
+        struct Sink
+        {
+            std::atomic<int64_t> received{ 0 };
+            int64_t checksum = 0;
+
+            void consume( const Record& record )
+            {
+                checksum += record.checksum;
+                received.fetch_add( 1, std::memory_order_release );
+            }
+        };
+
+        /** Thread executing the tasks posted to its unbounded queue, in order. */
+        class ThreadExecutor
+        {
+        public:
+            ThreadExecutor() : m_thread( [this]{ run(); } ) {}
+
+            ~ThreadExecutor()
+            {
+                {
+                    std::scoped_lock lock{ m_mutex };
+                    m_stopped = true;
+                }
+                m_condition.notify_one();
+                m_thread.join();
+            }
+
+            void post( std::function<void()> task )
+            {
+                {
+                    std::scoped_lock lock{ m_mutex };
+                    m_tasks.push_back( std::move( task ) );
+                }
+                m_condition.notify_one();
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            std::deque<std::function<void()>> m_tasks;
+            bool m_stopped = false;
+            std::thread m_thread;
+
+            void run()
+            {
+                std::unique_lock lock{ m_mutex };
+                while( true )
+                {
+                    m_condition.wait( lock, [this]{ return m_stopped || !m_tasks.empty(); } );
+                    if( m_tasks.empty() )
+                        return;
+                    auto task = std::move( m_tasks.front() );
+                    m_tasks.pop_front();
+                    lock.unlock();
+                    task();
+                    task = nullptr;
+                    lock.lock();
+                }
+            }
+        };
+
+        struct Measure
+        {
+            clock::duration duration;
+            int64_t peak_bytes; ///< Peak of the bytes allocated during the measure, beyond those allocated before.
+            int64_t checksum;
+        };
+
+        template< class Run >
+        Measure measure( Run&& run )
+        {
+            const auto bytes_before = allocated_bytes.load();
+            peak_allocated_bytes.store( bytes_before );
+            const auto begin = clock::now();
+            const auto checksum = run();
+            return { clock::now() - begin, peak_allocated_bytes.load() - bytes_before, checksum };
+        }
+
+        Measure measure_posted( const Options& options )
+        {
+            return measure( [&] {
+                Sink sink;
+                TaskSynchronizer decode_sync, transform_sync, sink_sync;
+                {
+                    ThreadExecutor decode_thread, transform_thread, sink_thread;
+                    const std::string message( options.payload, 'x' );
+                    for( int64_t index = 0; index < options.messages; ++index )
+                    {
+                        decode_thread.post( decode_sync.synchronized( [ &, message ]() mutable {
+                            transform_thread.post( transform_sync.synchronized( [ &, decoded = decode( std::move( message ) ) ]() mutable {
+                                sink_thread.post( sink_sync.synchronized( [ &, transformed = transform( std::move( decoded ) ) ] {
+                                    sink.consume( transformed );
+                                } ) );
+                            } ) );
+                        } ) );
+                    }
+                    while( sink.received.load( std::memory_order_acquire ) < options.messages )
+                        std::this_thread::sleep_for( std::chrono::microseconds{ 100 } );
+                }
+                return sink.checksum;
+            } );
+        }
+
+        Measure measure_pipeline( const Options& options )
+        {
+            return measure( [&] {
+                Sink sink;
+                {
+                    auto pipeline = tasksync::pipeline<std::string>( options.capacity, decode, transform,
+                                                                     [&]( const Record& record ) { sink.consume( record ); } );
+                    const std::string message( options.payload, 'x' );
+                    for( int64_t index = 0; index < options.messages; ++index )
+                        pipeline.push( message );
+                    pipeline.finish();
+                }
+                return sink.checksum;
+            } );
+        }
+
+        void print( const char* mode, const Options& options, const Measure& measure )
+        {
+            const auto seconds = std::chrono::duration<double>( measure.duration ).count();
+            std::printf( "%-10s %12.0f items/s %10.1f MiB peak   (checksum %lld)\n", mode,
+                         static_cast<double>( options.messages ) / seconds,
+                         static_cast<double>( measure.peak_bytes ) / ( 1024.0 * 1024.0 ),
+                         static_cast<long long>( measure.checksum ) );
+        }
+
+        Options parse_options( int argc, char* argv[] )
+        {
+            Options options;
+            for( int index = 1; index < argc; ++index )
+            {
+                const std::string argument = argv[ index ];
+                const char* value = index + 1 < argc ? argv[ index + 1 ] : nullptr;
+                if( argument == "--help" || !value )
+                {
+                    std::printf( "usage: %s [--messages N] [--payload BYTES] [--capacity N]\n", argv[ 0 ] );
+                    std::exit( argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE );
+                }
+
+                const auto integer = [&] { return std::max( 0ll, std::strtoll( value, nullptr, 10 ) ); };
+                if( argument == "--messages" )
+                    options.messages = std::max( 1ll, integer() );
+                else if( argument == "--payload" )
+                    options.payload = static_cast<std::size_t>( integer() );
+                else if( argument == "--capacity" )
+                    options.capacity = static_cast<std::size_t>( std::max( 1ll, integer() ) );
+                else
+                {
+                    std::fprintf( stderr, "unknown option: %s\n", argument.c_str() );
+                    std::exit( EXIT_FAILURE );
+                }
+                ++index;
+            }
+            return options;
+        }
+
+        void run( const Options& options )
+        {
+            std::printf( "tasksync-pipeline: %lld messages of %zu bytes, 3 stages, queues of %zu items\n",
+                         static_cast<long long>( options.messages ), options.payload, options.capacity );
+            print( "posted", options, measure_posted( options ) );
+            print( "pipeline", options, measure_pipeline( options ) );
+        }
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    pipeline_bench::run( pipeline_bench::parse_options( argc, argv ) );
+    return EXIT_SUCCESS;
+}
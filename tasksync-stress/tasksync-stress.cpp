@@ -0,0 +1,560 @@
+// Stress and interleaving tests for TaskSynchronizer.
+//
+// Random mode: threads invoke synchronized tasks, join, reset and destroy synchronizers at random
+// for some time, checking invariants, then report the throughput.
+//
+// Deterministic mode: a few threads run one at a time, handing over to each other at the schedule
+// points of tasksync (see TASKSYNC_SCHEDULE_POINT in tasksync/config.hpp) in an order drawn from a seed.
+// This explores the race windows of the implementation (between locking the status and checking for
+// a join, between ending a task and the join checking for it, etc.) and a failing schedule can be
+// replayed with its seed.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stress {
+
+    void schedule_point( const char* point );
+
+    template< class Condition, class Lock, class Predicate >
+    void schedule_wait( Condition& condition, Lock& lock, Predicate& predicate );
+
+    template< class Condition >
+    void schedule_notify( Condition& condition );
+
+}
+
+#define TASKSYNC_SCHEDULE_POINT( point ) ::stress::schedule_point( #point )
+#define TASKSYNC_SCHEDULE_WAIT( condition, lock, predicate ) ::stress::schedule_wait( condition, lock, predicate )
+#define TASKSYNC_SCHEDULE_NOTIFY( condition ) ::stress::schedule_notify( condition )
+
+#include <tasksync/tasksync.hpp>
+
+namespace stress {
+
+    using tasksync::TaskSynchronizer;
+
+    namespace {
+
+        std::string failure_context; // Set before starting threads, read-only while they run.
+
+        [[noreturn]] void fail( const char* message )
+        {
+            std::fprintf( stderr, "FAILURE: %s\n%s\n", message, failure_context.c_str() );
+            std::fflush( stderr );
+            std::_Exit( EXIT_FAILURE ); // Other threads may be blocked forever, don't wait for them.
+        }
+
+        void check( bool condition, const char* message )
+        {
+            if( !condition )
+                fail( message );
+        }
+
+        constexpr std::size_t not_scheduled = static_cast<std::size_t>( -1 );
+        thread_local std::size_t this_thread_slot = not_scheduled;
+
+        /** Runs threads one at a time, choosing which one continues at each schedule point from a seeded random sequence.
+            Waiting on a condition is modelled: a waiting thread does not run again until the condition is notified,
+            so a missing notification shows up as a deadlock instead of being hidden by polling.
+        */
+        class Scheduler
+        {
+        public:
+
+            explicit Scheduler( uint64_t seed ) : m_random( seed ) {}
+
+            static std::atomic<Scheduler*>& active()
+            {
+                static std::atomic<Scheduler*> scheduler{ nullptr };
+                return scheduler;
+            }
+
+            /** Run each script in its own thread, one at a time, until they all end. */
+            void run( const std::vector<std::function<void()>>& scripts )
+            {
+                m_states.assign( scripts.size(), ThreadState{} );
+                m_current = pick( scripts.size() );
+                active() = this;
+
+                std::vector<std::thread> threads;
+                for( std::size_t slot = 0; slot < scripts.size(); ++slot )
+                {
+                    threads.emplace_back( [ &, slot ] {
+                        this_thread_slot = slot;
+                        {
+                            std::unique_lock lock{ m_mutex };
+                            m_turn.wait( lock, [&]{ return m_current == slot; } );
+                        }
+                        scripts[ slot ]();
+                        {
+                            std::unique_lock lock{ m_mutex };
+                            m_states[ slot ].finished = true;
+                            pass_turn();
+                        }
+                        m_turn.notify_all();
+                        this_thread_slot = not_scheduled;
+                    } );
+                }
+
+                for( auto& thread : threads )
+                    thread.join();
+
+                active() = nullptr;
+            }
+
+            /** Let the scheduler choose which thread continues, possibly the calling one. */
+            void yield()
+            {
+                std::unique_lock lock{ m_mutex };
+                pass_turn();
+                wait_turn( lock );
+            }
+
+            /** Block the calling thread until another one notifies the condition. */
+            void wait( const void* condition )
+            {
+                std::unique_lock lock{ m_mutex };
+                m_states[ this_thread_slot ].waited_condition = condition;
+                pass_turn();
+                wait_turn( lock );
+            }
+
+            /** Unblock one of the threads waiting for the condition, if any. */
+            void notify_one( const void* condition )
+            {
+                std::unique_lock lock{ m_mutex };
+                std::vector<std::size_t> waiting;
+                for( std::size_t slot = 0; slot < m_states.size(); ++slot )
+                    if( m_states[ slot ].waited_condition == condition )
+                        waiting.push_back( slot );
+                if( !waiting.empty() )
+                    m_states[ waiting[ pick( waiting.size() ) ] ].waited_condition = nullptr;
+            }
+
+            int64_t switches() const { return m_switches; }
+
+        private:
+            struct ThreadState
+            {
+                bool finished = false;
+                const void* waited_condition = nullptr;
+            };
+
+            std::mutex m_mutex;
+            std::condition_variable m_turn;
+            std::mt19937_64 m_random;
+            std::vector<ThreadState> m_states;
+            std::size_t m_current = 0;
+            int64_t m_switches = 0;
+
+            std::size_t pick( std::size_t count )
+            {
+                return std::uniform_int_distribution<std::size_t>{ 0, count - 1 }( m_random );
+            }
+
+            void pass_turn()
+            {
+                std::vector<std::size_t> candidates;
+                bool unfinished = false;
+                for( std::size_t slot = 0; slot < m_states.size(); ++slot )
+                {
+                    unfinished = unfinished || !m_states[ slot ].finished;
+                    if( !m_states[ slot ].finished && !m_states[ slot ].waited_condition )
+                        candidates.push_back( slot );
+                }
+                if( candidates.empty() )
+                {
+                    if( unfinished )
+                        fail( "deadlock: all the remaining threads wait for a notification which will never come" );
+                    return;
+                }
+                m_current = candidates[ pick( candidates.size() ) ];
+                ++m_switches;
+            }
+
+            void wait_turn( std::unique_lock<std::mutex>& lock )
+            {
+                m_turn.notify_all();
+                m_turn.wait( lock, [&]{ return m_current == this_thread_slot; } );
+            }
+        };
+
+        Scheduler* scheduler_of_this_thread()
+        {
+            return this_thread_slot == not_scheduled ? nullptr : Scheduler::active().load();
+        }
+
+    }
+
+    void schedule_point( const char* )
+    {
+        if( auto* scheduler = scheduler_of_this_thread() )
+            scheduler->yield();
+    }
+
+    template< class Condition, class Lock, class Predicate >
+    void schedule_wait( Condition& condition, Lock& lock, Predicate& predicate )
+    {
+        auto* scheduler = scheduler_of_this_thread();
+        if( !scheduler )
+        {
+            condition.wait( lock, predicate );
+            return;
+        }
+
+        // Blocking for real would block all the scheduled threads: let the others run until notified.
+        while( !predicate() )
+        {
+            lock.unlock();
+            scheduler->wait( &condition );
+            lock.lock();
+        }
+    }
+
+    template< class Condition >
+    void schedule_notify( Condition& condition )
+    {
+        if( auto* scheduler = scheduler_of_this_thread() )
+            scheduler->notify_one( &condition );
+        else
+            condition.notify_one();
+    }
+
+    namespace {
+
+        /** Tracks the task bodies of a synchronizer between two joins, to check them against the join. */
+        struct Epoch
+        {
+            std::atomic<bool> joined{ false };
+            std::atomic<int64_t> executing{ 0 };
+        };
+
+        struct Counters
+        {
+            std::atomic<int64_t> invocations{ 0 };
+            std::atomic<int64_t> executions{ 0 };
+            std::atomic<int64_t> joins{ 0 };
+            std::atomic<int64_t> resets{ 0 };
+            std::atomic<int64_t> destructions{ 0 };
+        };
+
+        /** A synchronizer and the state needed to check the tasks it synchronizes. */
+        class Synchronized
+        {
+        public:
+
+            /** @return A synchronized task checking that it never executes outside of its synchronizer's epoch. */
+            std::function<void()> make_task( Counters& counters, int spin_count )
+            {
+                return m_task_sync.synchronized( [ sync = &m_task_sync, epoch = m_epoch, &counters, spin_count ] {
+                    check( !epoch->joined, "a task body began after its synchronizer was joined" );
+                    ++epoch->executing;
+                    schedule_point( "body" );
+                    // Reading both counters is only atomic when threads run one at a time.
+                    const auto min_running_tasks = scheduler_of_this_thread() ? epoch->executing.load() : 1;
+                    check( sync->running_tasks() >= min_running_tasks, "running_tasks() is lower than the number of executing task bodies" );
+                    for( std::atomic<int> spin = 0; spin < spin_count; ++spin ) {}
+                    schedule_point( "body" );
+                    check( !epoch->joined, "a join returned while a task body was executing" );
+                    --epoch->executing;
+                    ++counters.executions;
+                } );
+            }
+
+            void join( Counters& counters )
+            {
+                m_task_sync.join_tasks();
+                end_epoch();
+                check( m_task_sync.is_joined(), "is_joined() is false after join_tasks()" );
+                ++counters.joins;
+            }
+
+            void reset( Counters& counters )
+            {
+                m_task_sync.reset();
+                end_epoch();
+                check( !m_task_sync.is_joined(), "is_joined() is true after reset()" );
+                m_epoch = std::make_shared<Epoch>();
+                ++counters.resets;
+            }
+
+            ~Synchronized()
+            {
+                m_task_sync.join_tasks();
+                end_epoch();
+            }
+
+        private:
+            std::shared_ptr<Epoch> m_epoch = std::make_shared<Epoch>();
+            TaskSynchronizer m_task_sync; // Last: joined before the epoch is released.
+
+            void end_epoch()
+            {
+                m_epoch->joined = true;
+                check( m_epoch->executing == 0, "a join returned while task bodies were executing" );
+                check( m_task_sync.running_tasks() == 0, "running_tasks() is not 0 after a join" );
+            }
+        };
+
+        /** Tasks shared between threads, which can be invoked by any of them. */
+        class TaskPool
+        {
+        public:
+            explicit TaskPool( std::size_t size ) : m_tasks( size ) {}
+
+            void store( std::size_t index, std::function<void()> task )
+            {
+                std::scoped_lock lock{ m_mutex };
+                m_tasks[ index % m_tasks.size() ].swap( task );
+            }
+
+            void invoke( std::size_t index, Counters& counters )
+            {
+                std::function<void()> task;
+                {
+                    std::scoped_lock lock{ m_mutex };
+                    task = m_tasks[ index % m_tasks.size() ];
+                }
+                if( task )
+                {
+                    ++counters.invocations;
+                    task();
+                }
+            }
+
+            void clear()
+            {
+                std::scoped_lock lock{ m_mutex };
+                m_tasks.assign( m_tasks.size(), nullptr );
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::vector<std::function<void()>> m_tasks;
+        };
+
+        struct Options
+        {
+            enum class Mode { both, random, deterministic };
+
+            Mode mode = Mode::both;
+            unsigned threads = std::clamp( std::thread::hardware_concurrency(), 2u, 16u );
+            double seconds = 1.0;
+            uint64_t seed = std::random_device{}();
+            int schedules = 500;
+        };
+
+        void run_random( const Options& options )
+        {
+            Counters counters;
+            TaskPool pool{ options.threads * 8 };
+            std::atomic<bool> stop{ false };
+
+            const auto begin = std::chrono::steady_clock::now();
+
+            std::vector<std::thread> threads;
+            for( unsigned thread_index = 0; thread_index < options.threads; ++thread_index )
+            {
+                threads.emplace_back( [ &, thread_index ] {
+                    std::mt19937_64 random{ options.seed + thread_index };
+                    std::uniform_int_distribution<int> percent{ 0, 99 };
+                    // Each thread owns a synchronizer: joining, resetting and wrapping tasks happen on the owning thread.
+                    auto owned = std::make_unique<Synchronized>();
+
+                    while( !stop.load( std::memory_order_relaxed ) )
+                    {
+                        const auto choice = percent( random );
+                        if( choice < 70 )
+                            pool.invoke( random(), counters );
+                        else if( choice < 90 )
+                            pool.store( random(), owned->make_task( counters, percent( random ) * 10 ) );
+                        else if( choice < 96 )
+                            owned->reset( counters );
+                        else if( choice < 98 )
+                        {
+                            owned->join( counters );
+                            owned->reset( counters );
+                        }
+                        else
+                        {
+                            owned = std::make_unique<Synchronized>();
+                            ++counters.destructions;
+                        }
+                    }
+                } );
+            }
+
+            std::this_thread::sleep_for( std::chrono::duration<double>{ options.seconds } );
+            stop = true;
+            for( auto& thread : threads )
+                thread.join();
+            pool.clear();
+
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+            const auto invocations = counters.invocations.load();
+            const auto executions = counters.executions.load();
+            std::printf( "random: %u threads, %.2fs, seed %llu\n", options.threads, elapsed.count(),
+                         static_cast<unsigned long long>( options.seed ) );
+            std::printf( "  %lld invocations (%.0f/s): %lld executed, %lld skipped\n",
+                         static_cast<long long>( invocations ), invocations / elapsed.count(),
+                         static_cast<long long>( executions ), static_cast<long long>( invocations - executions ) );
+            std::printf( "  %lld joins, %lld resets, %lld destructions (%.0f joining operations/s)\n",
+                         static_cast<long long>( counters.joins.load() ), static_cast<long long>( counters.resets.load() ),
+                         static_cast<long long>( counters.destructions.load() ),
+                         ( counters.joins + counters.resets + counters.destructions ) / elapsed.count() );
+        }
+
+        /** Run one schedule: an owner thread joins, resets and destroys a synchronizer
+            while worker threads invoke its tasks, all interleaved by the scheduler.
+        */
+        int64_t run_schedule( uint64_t seed )
+        {
+            std::mt19937_64 random{ seed };
+            const auto draw = [&]( int count ) { return std::uniform_int_distribution<int>{ 0, count - 1 }( random ); };
+
+            Counters counters;
+            std::optional<Synchronized> synchronized{ std::in_place };
+
+            std::mutex published_mutex;
+            std::vector<std::function<void()>> published;
+            for( int index = 0; index < 3; ++index )
+                published.push_back( synchronized->make_task( counters, 0 ) );
+
+            const auto invoke_published = [&]( std::size_t index ) {
+                std::function<void()> task;
+                {
+                    std::scoped_lock lock{ published_mutex };
+                    task = published[ index % published.size() ];
+                }
+                ++counters.invocations;
+                task();
+            };
+
+            std::vector<std::function<void()>> scripts;
+
+            // Owner: a few operations then destruction.
+            std::vector<int> owner_operations( 1 + draw( 3 ) );
+            for( auto& operation : owner_operations )
+                operation = draw( 3 );
+            scripts.push_back( [ &, owner_operations ] {
+                for( const auto operation : owner_operations )
+                {
+                    switch( operation )
+                    {
+                    case 0: invoke_published( 0 ); break;
+                    case 1: synchronized->join( counters ); break;
+                    case 2:
+                    {
+                        synchronized->reset( counters );
+                        auto task = synchronized->make_task( counters, 0 );
+                        std::scoped_lock lock{ published_mutex };
+                        published.push_back( std::move( task ) );
+                        break;
+                    }
+                    }
+                    schedule_point( "owner" );
+                }
+                synchronized.reset();
+                ++counters.destructions;
+            } );
+
+            // Workers: invoke published tasks.
+            const int worker_count = 1 + draw( 2 );
+            for( int worker = 0; worker < worker_count; ++worker )
+            {
+                std::vector<std::size_t> invocations( 1 + draw( 4 ) );
+                for( auto& index : invocations )
+                    index = random();
+                scripts.push_back( [ &, invocations ] {
+                    for( const auto index : invocations )
+                        invoke_published( index );
+                } );
+            }
+
+            Scheduler scheduler{ seed };
+            scheduler.run( scripts );
+            return scheduler.switches();
+        }
+
+        void run_deterministic( const Options& options )
+        {
+            int64_t switches = 0;
+            for( int schedule = 0; schedule < options.schedules; ++schedule )
+            {
+                const auto seed = options.seed + static_cast<uint64_t>( schedule );
+                failure_context = "replay with: --mode deterministic --schedules 1 --seed " + std::to_string( seed );
+                switches += run_schedule( seed );
+            }
+            failure_context.clear();
+
+            std::printf( "deterministic: %d schedules, %lld thread switches, seeds %llu to %llu\n",
+                         options.schedules, static_cast<long long>( switches ),
+                         static_cast<unsigned long long>( options.seed ),
+                         static_cast<unsigned long long>( options.seed + options.schedules - 1 ) );
+        }
+
+        Options parse_options( int argc, char* argv[] )
+        {
+            Options options;
+            for( int index = 1; index < argc; ++index )
+            {
+                const std::string argument = argv[ index ];
+                const char* value = index + 1 < argc ? argv[ index + 1 ] : nullptr;
+                if( argument == "--help" || !value )
+                {
+                    std::printf( "usage: %s [--mode both|random|deterministic] [--threads N] [--seconds S] [--schedules N] [--seed N]\n", argv[ 0 ] );
+                    std::exit( argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE );
+                }
+
+                if( argument == "--mode" )
+                {
+                    const std::string mode = value;
+                    options.mode = mode == "random" ? Options::Mode::random
+                                 : mode == "deterministic" ? Options::Mode::deterministic
+                                 : Options::Mode::both;
+                }
+                else if( argument == "--threads" )
+                    options.threads = static_cast<unsigned>( std::max( 1l, std::strtol( value, nullptr, 10 ) ) );
+                else if( argument == "--seconds" )
+                    options.seconds = std::strtod( value, nullptr );
+                else if( argument == "--schedules" )
+                    options.schedules = static_cast<int>( std::strtol( value, nullptr, 10 ) );
+                else if( argument == "--seed" )
+                    options.seed = std::strtoull( value, nullptr, 10 );
+                ++index;
+            }
+            return options;
+        }
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    const auto options = stress::parse_options( argc, argv );
+
+    if( options.mode != stress::Options::Mode::random )
+        stress::run_deterministic( options );
+
+    if( options.mode != stress::Options::Mode::deterministic )
+    {
+        stress::failure_context = "random mode seed " + std::to_string( options.seed );
+        stress::run_random( options );
+    }
+
+    return EXIT_SUCCESS;
+}
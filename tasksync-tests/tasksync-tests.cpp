@@ -12,11 +12,44 @@ import tasksync;
 #   include <atomic>
 #   include <string>
 #   include <type_traits>
+#   include <optional>
+#   include <sstream>
+#   include <vector>
+#   include <algorithm>
+#   include <mutex>
+#   include <array>
+#   include <functional>
+#   include <stop_token>
+#   include <chrono>
+#   include <memory>
 
 #   include <tasksync/tasksync.hpp>
+#   include <tasksync/timer_wheel.hpp>
+#   include <tasksync/signal.hpp>
+#   include <tasksync/task_group.hpp>
+#   include <tasksync/parallel_for.hpp>
+#   include <tasksync/sender.hpp>
+#   include <tasksync/submit.hpp>
+#   include <tasksync/chain.hpp>
+#   include <tasksync/pipeline.hpp>
+#   include <tasksync/reactor.hpp>
+#   include <tasksync/shared_sync.hpp>
+#   if TASKSYNC_WATCHDOG
+#       include <tasksync/watchdog.hpp>
+#   endif
+#   if TASKSYNC_REGISTRY
+#       include <tasksync/metrics.hpp>
+#   endif
 
 #endif
 
+#if defined(__linux__)
+#   include <fcntl.h>
+#   include <sys/socket.h>
+#   include <sys/wait.h>
+#   include <unistd.h>
+#endif
+
 using namespace tasksync;
 
 
@@ -190,4 +223,1451 @@ TEST_CASE( "throwing task never block join" )
     CHECK_THROWS_AS( task_future.get(), int );
 }
 
+TEST_CASE( "exceptions captured by synchronized tasks are thrown by the next join" )
+{
+    TaskSynchronizer task_sync;
+    auto throwing_task = task_sync.synchronized<tasksync::ExceptionPolicy::capture>( []( int value ) { throw value; } );
+    static_assert( noexcept( throwing_task( 1 ) ) );
+
+    throwing_task( 1 );
+    throwing_task( 2 ); // Dropped, only the first one is kept.
+    CHECK( task_sync.running_tasks() == 0 );
+    CHECK_THROWS_AS( task_sync.reset(), int );
+    CHECK( !task_sync.is_joined() );
+    task_sync.join_tasks(); // Thrown once.
+
+    task_sync.reset();
+    auto labelled_task = task_sync.synchronized<tasksync::ExceptionPolicy::capture>( "labelled", [] { throw 3; } );
+    std::thread{ labelled_task }.join();
+    int thrown = 0;
+    try
+    {
+        task_sync.join_tasks();
+    }
+    catch( int value )
+    {
+        thrown = value;
+    }
+    CHECK( thrown == 3 );
+    CHECK( task_sync.is_joined() );
+}
+
+#if defined(__linux__)
+
+namespace {
+    /** Fork a process executing `child`, which returns its exit code. */
+    template< class Child >
+    pid_t fork_child( Child&& child )
+    {
+        const auto pid = ::fork();
+        REQUIRE( pid >= 0 );
+        if( pid == 0 )
+        {
+            int code = EXIT_FAILURE;
+            try
+            {
+                code = child();
+            }
+            catch( ... )
+            {
+            }
+            ::_exit( code );
+        }
+        return pid;
+    }
+
+    /** @return The exit code of the child process, or -1 if it did not exit normally. */
+    int wait_child( pid_t pid )
+    {
+        int status = 0;
+        REQUIRE( ::waitpid( pid, &status, 0 ) == pid );
+        return WIFEXITED( status ) ? WEXITSTATUS( status ) : -1;
+    }
+}
+
+TEST_CASE( "synchronized tasks can terminate on exceptions" )
+{
+    TaskSynchronizer task_sync;
+    const auto child = fork_child( [&] {
+        task_sync.synchronized<tasksync::ExceptionPolicy::terminate>( [] { throw 1; } )();
+        return EXIT_SUCCESS;
+    } );
+    CHECK( wait_child( child ) == -1 ); // Aborted.
+}
+
+#endif
+
+TEST_CASE( "synchronized tasks are noexcept when their body is" )
+{
+    TaskSynchronizer task_sync;
+    int executed = 0;
+    auto nothrow_task = task_sync.synchronized( [&]() noexcept { ++executed; } );
+    auto throwing_task = task_sync.synchronized( [&] { ++executed; } );
+    static_assert( noexcept( nothrow_task() ) );
+    static_assert( !noexcept( throwing_task() ) );
+    auto terminating_task = task_sync.synchronized<tasksync::ExceptionPolicy::terminate>( [] { throw 1; } );
+    static_assert( noexcept( terminating_task() ) );
+
+    nothrow_task();
+    throwing_task();
+    CHECK( executed == 2 );
+    CHECK( task_sync.running_tasks() == 0 );
+    task_sync.join_tasks();
+    nothrow_task();
+    CHECK( executed == 2 );
+}
+
+TEST_CASE( "member functions are synchronized as compile time bound calls" )
+{
+    struct Listener
+    {
+        std::string events;
+        void on_event( const std::string& event, int count ) { events.append( static_cast<std::size_t>( count ), event.front() ); }
+        void on_reset() noexcept { events.clear(); }
+        int size() const { return static_cast<int>( events.size() ); }
+    };
+
+    Listener listener;
+    TaskSynchronizer task_sync;
+    auto on_event = task_sync.synchronized<&Listener::on_event>( listener );
+    auto on_reset = task_sync.synchronized<&Listener::on_reset>( listener );
+    auto size = task_sync.synchronized<&Listener::size>( std::as_const( listener ) );
+    static_assert( std::is_same_v<decltype( on_event )::signature, void( const std::string&, int )> );
+    static_assert( noexcept( on_reset() ) && !noexcept( size() ) );
+#if !TASKSYNC_DETAILS_TASK_ORIGIN && !TASKSYNC_WRAPPER_ACCOUNTING
+    static_assert( sizeof( on_event ) == sizeof( std::weak_ptr<int> ) + sizeof( Listener* ) );
+    static_assert( sizeof( on_event ) < sizeof( task_sync.synchronized( [&]{ listener.on_reset(); } ) ) );
+#endif
+
+    std::function<decltype( on_event )::signature> slot = on_event; // Stored in a typed slot.
+    slot( "a", 2 );
+    on_event( std::string{ "b" }, 1 );
+    size();
+    CHECK( listener.events == "aab" );
+    on_reset();
+    CHECK( listener.events.empty() );
+
+    task_sync.join_tasks();
+    slot( "a", 2 );
+    CHECK( listener.events.empty() );
+    CHECK( task_sync.running_tasks() == 0 );
+}
+
+TEST_CASE( "stop tokens are stopped by joining" )
+{
+    TaskSynchronizer task_sync;
+    auto token = task_sync.get_stop_token();
+    CHECK_FALSE( token.stop_requested() );
+
+    int stop_count = 0;
+    std::stop_callback on_stop{ token, [&]{ ++stop_count; } };
+    task_sync.reset();
+    CHECK( token.stop_requested() );
+    CHECK( stop_count == 1 );
+
+    auto next_token = task_sync.get_stop_token();
+    CHECK_FALSE( next_token.stop_requested() );
+    task_sync.join_tasks();
+    CHECK( next_token.stop_requested() );
+    CHECK( task_sync.get_stop_token().stop_requested() );
+    CHECK( stop_count == 1 );
+}
+
+TEST_CASE( "owned threads are stopped and joined with the tasks" )
+{
+    TaskSynchronizer task_sync;
+    std::atomic<int> started{ 0 };
+    std::atomic<int> stopped{ 0 };
+    const auto resource = std::make_shared<int>( 42 );
+
+    const auto worker = [&, resource]( std::stop_token stop_token ) {
+        ++started;
+        while( !stop_token.stop_requested() )
+            std::this_thread::yield();
+        ++stopped;
+    };
+    for( int index = 0; index < 3; ++index )
+        CHECK( task_sync.spawn_thread( worker ) );
+
+    std::promise<void> task_end;
+    auto synched_task = task_sync.synchronized( [&]{ task_end.get_future().wait(); } );
+    auto task = std::async( std::launch::async, synched_task );
+    wait_condition( [&]{ return started == 3 && task_sync.running_tasks() == 1; } );
+    CHECK( task_sync.owned_threads() == 3 );
+
+    auto join = std::async( std::launch::async, [&]{ task_sync.join_tasks(); } );
+    wait_condition( [&]{ return stopped == 3; } ); // Stopped while the task still runs.
+    CHECK( join.wait_for( std::chrono::milliseconds( 10 ) ) == std::future_status::timeout );
+    task_end.set_value();
+    join.get();
+    CHECK( task_sync.owned_threads() == 0 );
+    CHECK( resource.use_count() == 2 ); // Only held by `worker`: the copies of the threads were destroyed before the join ended.
+
+    CHECK_FALSE( task_sync.spawn_thread( worker ) );
+    task_sync.reset();
+    CHECK( task_sync.spawn_thread( worker ) );
+    task_sync.join_tasks();
+    CHECK( stopped == 4 );
+}
+
+
+#if TASKSYNC_STATS
+
+TEST_CASE( "stats count executed and skipped tasks and joins" )
+{
+    TaskSynchronizer task_sync;
+    CHECK( task_sync.stats().executed_tasks == 0 );
+
+    auto synched_task = task_sync.synchronized( [] {} );
+    synched_task();
+    synched_task();
+
+    auto stats = task_sync.stats();
+    CHECK( stats.executed_tasks == 2 );
+    CHECK( stats.skipped_tasks == 0 );
+    CHECK( stats.peak_running_tasks == 1 );
+    CHECK( stats.joins == 0 );
+
+    std::atomic<bool> join_started{ false };
+    auto ft_task = std::async( std::launch::async, task_sync.synchronized( [&]{
+        wait_condition( [&]{ return join_started.load(); } );
+        std::this_thread::sleep_for( std::chrono::milliseconds{ 10 } );
+    } ) );
+    wait_condition( [&]{ return task_sync.running_tasks() == 1; } );
+
+    join_started = true;
+    task_sync.join_tasks();
+    task_sync.join_tasks(); // Already joined, not counted.
+
+    stats = task_sync.stats();
+    CHECK( stats.executed_tasks == 3 );
+    CHECK( stats.joins == 1 );
+    CHECK( stats.join_wait_time > std::chrono::nanoseconds{ 0 } );
+
+    task_sync.reset();
+    task_sync.join_tasks();
+    CHECK( task_sync.stats().joins == 2 );
+}
+
+TEST_CASE( "stats peak running tasks" )
+{
+    TaskSynchronizer task_sync;
+    std::atomic<int> started{ 0 };
+    std::atomic<bool> release{ false };
+
+    auto blocking_task = task_sync.synchronized( [&]{
+        ++started;
+        wait_condition( [&]{ return release.load(); } );
+    } );
+
+    auto ft_first = std::async( std::launch::async, blocking_task );
+    auto ft_second = std::async( std::launch::async, blocking_task );
+    wait_condition( [&]{ return started == 2; } );
+    release = true;
+
+    task_sync.join_tasks();
+    CHECK( task_sync.stats().peak_running_tasks == 2 );
+}
+
+#endif
+
+TEST_CASE( "duration histogram percentiles and merge" )
+{
+    using std::chrono::nanoseconds;
+
+    DurationHistogram histogram;
+    CHECK( histogram.count() == 0 );
+    CHECK( histogram.p50() == nanoseconds{ 0 } );
+
+    for( int i = 1; i <= 100; ++i )
+        histogram.record( nanoseconds{ i * 1000 } );
+
+    CHECK( histogram.count() == 100 );
+    CHECK( histogram.max() == nanoseconds{ 100000 } );
+    CHECK( histogram.p50() >= nanoseconds{ 50000 } );
+    CHECK( histogram.p50() <= nanoseconds{ 50000 * 9 / 8 } );
+    CHECK( histogram.p99() >= nanoseconds{ 99000 } );
+    CHECK( histogram.p99() <= histogram.max() );
+
+    DurationHistogram other;
+    other.record( std::chrono::seconds{ 1 } );
+    histogram.merge( other );
+    CHECK( histogram.count() == 101 );
+    CHECK( histogram.max() == std::chrono::seconds{ 1 } );
+
+    for( std::size_t index = 1; index < DurationHistogram::bucket_count; ++index )
+    {
+        const auto upper_bound = DurationHistogram::bucket_upper_bound( index );
+        CHECK( DurationHistogram::bucket_index( upper_bound ) == index );
+        CHECK( DurationHistogram::bucket_index( upper_bound + 1 ) == ( index + 1 < DurationHistogram::bucket_count ? index + 1 : index ) );
+    }
+}
+
+#if TASKSYNC_HISTOGRAMS
+
+TEST_CASE( "task durations are sampled" )
+{
+    TaskSynchronizer task_sync;
+    task_sync.set_task_duration_sampling( 1 );
+
+    auto synched_task = task_sync.synchronized( [] { std::this_thread::sleep_for( std::chrono::milliseconds{ 1 } ); } );
+    synched_task();
+    synched_task();
+    CHECK( task_sync.task_durations().count() == 2 );
+    CHECK( task_sync.task_durations().p50() >= std::chrono::milliseconds{ 1 } );
+
+    task_sync.set_task_duration_sampling( 0 );
+    synched_task();
+    CHECK( task_sync.task_durations().count() == 2 );
+
+    task_sync.set_task_duration_sampling( 4 );
+    for( int i = 0; i < 8; ++i )
+        synched_task();
+    CHECK( task_sync.task_durations().count() == 4 );
+}
+
+TEST_CASE( "synchronizers sampling task durations at different rates on a thread do not skew each other" )
+{
+    TaskSynchronizer one_in_two, one_in_three;
+    one_in_two.set_task_duration_sampling( 2 );
+    one_in_three.set_task_duration_sampling( 3 );
+
+    auto first_task = one_in_two.synchronized( [] {} );
+    auto second_task = one_in_three.synchronized( [] {} );
+    for( int i = 0; i < 12; ++i )
+    {
+        first_task();
+        second_task();
+    }
+    CHECK( one_in_two.task_durations().count() == 6 );
+    CHECK( one_in_three.task_durations().count() == 4 );
+}
+
+#endif
+
+#if TASKSYNC_CPU_TIME
+
+TEST_CASE( "cpu time of tasks tells compute bound tasks from blocked ones" )
+{
+    const auto duration = std::chrono::milliseconds{ 20 };
+    TaskSynchronizer computing, sleeping;
+    computing.set_task_time_sampling( 1 );
+    sleeping.set_task_time_sampling( 1 );
+    CHECK( computing.task_times().cpu_ratio() == 0.0 );
+
+    computing.synchronized( [&] {
+        const auto begin = std::chrono::steady_clock::now();
+        volatile uint64_t spins = 0;
+        while( std::chrono::steady_clock::now() - begin < duration )
+            spins = spins + 1;
+    } )();
+    auto sleeping_task = sleeping.synchronized( [&] { std::this_thread::sleep_for( duration ); } );
+    sleeping_task();
+
+    const auto computed = computing.task_times();
+    CHECK( computed.samples == 1 );
+    CHECK( computed.wall_time >= duration );
+    CHECK( computed.cpu_time > std::chrono::nanoseconds{ 0 } );
+    const auto slept = sleeping.task_times();
+    CHECK( slept.wall_time >= duration );
+    CHECK( slept.cpu_ratio() < 0.5 );
+    CHECK( computed.cpu_ratio() > slept.cpu_ratio() );
+
+    sleeping.set_task_time_sampling( 0 );
+    sleeping_task();
+    CHECK( sleeping.task_times().samples == 1 );
+}
+
+TEST_CASE( "synchronizers sampling task times at different rates on a thread do not skew each other" )
+{
+    TaskSynchronizer one_in_two, one_in_three;
+    one_in_two.set_task_time_sampling( 2 );
+    one_in_three.set_task_time_sampling( 3 );
+
+    auto first_task = one_in_two.synchronized( [] {} );
+    auto second_task = one_in_three.synchronized( [] {} );
+    for( int i = 0; i < 12; ++i )
+    {
+        first_task();
+        second_task();
+    }
+    CHECK( one_in_two.task_times().samples == 6 );
+    CHECK( one_in_three.task_times().samples == 4 );
+}
+
+#endif
+
+#if TASKSYNC_CALL_SITES
+
+namespace {
+    CallSiteStats find_call_site( uint_least32_t line )
+    {
+        for( const auto& site : call_site_stats() )
+            if( site.location.line() == line && std::string_view{ site.location.file_name() } == __FILE__ )
+                return site;
+        return {};
+    }
+}
+
+TEST_CASE( "call sites count executed and skipped tasks" )
+{
+    const auto line = std::source_location::current().line() + 3;
+    std::optional<TaskSynchronizer> task_sync{ std::in_place };
+    std::atomic<bool> join_requested{ false };
+    auto synched_task = task_sync->synchronized( [&]{
+        if( join_requested ) std::this_thread::sleep_for( std::chrono::milliseconds{ 10 } ); } );
+
+    synched_task();
+    CHECK( find_call_site( line ).executed_tasks == 1 );
+
+    join_requested = true;
+    auto ft_task = std::async( std::launch::async, synched_task );
+    wait_condition( [&]{ return task_sync->running_tasks() == 1; } );
+    task_sync.reset(); // Destroys the synchronizer, joining the running task.
+
+    synched_task();
+
+    const auto site = find_call_site( line );
+    CHECK( site.executed_tasks == 2 );
+    CHECK( site.skipped_tasks == 1 );
+    CHECK( site.time_under_join > std::chrono::nanoseconds{ 0 } );
+}
+
+#endif
+
+#if TASKSYNC_RUNNING_REGISTRY
+
+TEST_CASE( "running tasks can be listed while they execute" )
+{
+    TaskSynchronizer task_sync;
+    std::atomic<bool> task_started{ false };
+    std::atomic<bool> task_continue{ false };
+
+    auto ft_task = std::async( std::launch::async, task_sync.synchronized( "blocking task", [&]{
+        task_started = true;
+        wait_condition( [&]{ return task_continue.load(); } );
+    } ) );
+    wait_condition( [&]{ return task_started.load(); } );
+
+    int running_count = 0;
+    visit_running_tasks( [&]( const RunningTask& task ) {
+        if( task.synchronizer != &task_sync )
+            return;
+        ++running_count;
+        CHECK( std::string{ task.label } == "blocking task" );
+        CHECK( task.thread != std::this_thread::get_id() );
+        CHECK( task.start <= std::chrono::steady_clock::now() );
+    } );
+    CHECK( running_count == 1 );
+
+    std::ostringstream dump;
+    task_sync.dump_running( dump );
+    CHECK( dump.str().find( "'blocking task'" ) != std::string::npos );
+
+    task_continue = true;
+    task_sync.join_tasks();
+
+    running_count = 0;
+    visit_running_tasks( [&]( const RunningTask& task ) { running_count += task.synchronizer == &task_sync; } );
+    CHECK( running_count == 0 );
+}
+
+#endif
+
+#if TASKSYNC_WATCHDOG
+
+TEST_CASE( "watchdog reports slow tasks and joins once" )
+{
+    std::mutex reports_mutex;
+    std::vector<WatchdogReport> reports;
+    const auto count_reports = [&]( WatchdogReport::Kind kind ) {
+        std::scoped_lock lock{ reports_mutex };
+        return std::count_if( reports.begin(), reports.end(), [&]( const auto& report ){ return report.kind == kind; } );
+    };
+
+    Watchdog watchdog{ std::chrono::milliseconds{ 5 }, std::chrono::milliseconds{ 20 }, std::chrono::milliseconds{ 20 },
+        [&]( const WatchdogReport& report ) {
+            std::scoped_lock lock{ reports_mutex };
+            reports.push_back( report );
+        } };
+
+    TaskSynchronizer task_sync;
+    auto ft_task = std::async( std::launch::async, task_sync.synchronized( "slow task", [&]{
+        wait_condition( [&]{ return count_reports( WatchdogReport::Kind::slow_join ) > 0; } );
+    } ) );
+
+    wait_condition( [&]{ return count_reports( WatchdogReport::Kind::slow_task ) > 0; } );
+    task_sync.join_tasks();
+    std::this_thread::sleep_for( std::chrono::milliseconds{ 20 } );
+
+    std::scoped_lock lock{ reports_mutex };
+    REQUIRE( reports.size() == 2 );
+    CHECK( reports[ 0 ].kind == WatchdogReport::Kind::slow_task );
+    CHECK( reports[ 0 ].synchronizer == &task_sync );
+    CHECK( std::string{ reports[ 0 ].label } == "slow task" );
+    CHECK( reports[ 0 ].elapsed >= std::chrono::milliseconds{ 20 } );
+    CHECK( reports[ 1 ].kind == WatchdogReport::Kind::slow_join );
+    CHECK( reports[ 1 ].thread == std::this_thread::get_id() );
+    CHECK( reports[ 1 ].running_tasks == 1 );
+}
+
+#endif
+
+#if TASKSYNC_TRACE
+
+TEST_CASE( "traced synchronizers record chrome trace events" )
+{
+    TaskSynchronizer traced_sync;
+    traced_sync.set_traced( true );
+    TaskSynchronizer untraced_sync;
+
+    traced_sync.synchronized( "traced \"task\"", []{} )();
+    untraced_sync.synchronized( "untraced task", []{} )();
+    traced_sync.join_tasks();
+
+    std::ostringstream trace;
+    write_chrome_trace( trace );
+    const auto json = trace.str();
+
+    CHECK( json.find( "\"traceEvents\":[" ) != std::string::npos );
+    CHECK( json.find( "{\"name\":\"traced \\\"task\\\"\",\"cat\":\"tasksync\",\"ph\":\"B\"" ) != std::string::npos );
+    CHECK( json.find( "\"name\":\"task\",\"cat\":\"tasksync\",\"ph\":\"E\"" ) != std::string::npos );
+    CHECK( json.find( "\"name\":\"join\",\"cat\":\"tasksync\",\"ph\":\"B\"" ) != std::string::npos );
+    CHECK( json.find( "\"name\":\"join\",\"cat\":\"tasksync\",\"ph\":\"E\"" ) != std::string::npos );
+    CHECK( json.find( "untraced task" ) == std::string::npos );
+}
+
+#endif
+
+#if TASKSYNC_REGISTRY
+
+TEST_CASE( "synchronizers metrics are exposed while they exist" )
+{
+    std::optional<TaskSynchronizer> task_sync{ std::in_place };
+    task_sync->set_metrics_name( "some \"system\"" );
+    task_sync->synchronized( []{} )();
+
+    auto metrics = render_metrics();
+    CHECK( metrics.find( "# TYPE tasksync_executed_tasks_total counter\n" ) != std::string::npos );
+    CHECK( metrics.find( ",name=\"some \\\"system\\\"\"} 1\n" ) != std::string::npos );
+    CHECK( metrics.find( "tasksync_join_state{" ) != std::string::npos );
+
+    task_sync->join_tasks();
+    std::ostringstream expected_state;
+    expected_state << "tasksync_join_state{synchronizer=\"" << static_cast<const void*>( &*task_sync ) << "\",name=\"some \\\"system\\\"\"} 2\n";
+    CHECK( render_metrics().find( expected_state.str() ) != std::string::npos );
+
+    task_sync.reset();
+    CHECK( render_metrics().find( "some \\\"system\\\"" ) == std::string::npos );
+}
+
+#endif
+
+#if TASKSYNC_WRAPPER_ACCOUNTING
+
+TEST_CASE( "live wrappers are accounted until destroyed" )
+{
+    TaskSynchronizer task_sync;
+    CHECK( task_sync.wrapper_stats().live_wrappers == 0 );
+
+    std::array<char, 100> big_capture{};
+    auto synched_task = task_sync.synchronized( [big_capture]{ (void)big_capture; } );
+    CHECK( task_sync.wrapper_stats().live_wrappers == 1 );
+    CHECK( task_sync.wrapper_stats().captured_bytes == 100 );
+
+    {
+        auto copy = synched_task;
+        auto moved = std::move( copy );
+        CHECK( task_sync.wrapper_stats().live_wrappers == 2 );
+        CHECK( task_sync.wrapper_stats().captured_bytes == 200 );
+    }
+    CHECK( task_sync.wrapper_stats().live_wrappers == 1 );
+
+    task_sync.join_tasks();
+    std::vector<std::function<void()>> dead_callbacks( 3, synched_task );
+    CHECK( task_sync.wrapper_stats().live_wrappers == 4 );
+
+    dead_callbacks.clear();
+    CHECK( task_sync.wrapper_stats().live_wrappers == 1 );
+}
+
+TEST_CASE( "wrappers can outlive their accounting synchronizer" )
+{
+    std::optional<TaskSynchronizer> task_sync{ std::in_place };
+    auto synched_task = task_sync->synchronized( []{} );
+    task_sync.reset();
+    auto copy = synched_task;
+    copy();
+}
+
+#endif
+
+TEST_CASE( "timers fire once expired" )
+{
+    using namespace std::chrono_literals;
+    const auto start = TimerWheel::clock::now();
+    TimerWheel wheel{ 1ms, start };
+    TaskSynchronizer task_sync;
+
+    std::vector<int> fired;
+    wheel.schedule_after( task_sync, 3ms, [&]{ fired.push_back( 3 ); } );
+    wheel.schedule_after( task_sync, 1ms, [&]{ fired.push_back( 1 ); } );
+    wheel.schedule_after( task_sync, 70'000ms, [&]{ fired.push_back( 70'000 ); } ); // Cascades through 2 levels.
+    CHECK( wheel.pending() == 3 );
+
+    CHECK( wheel.advance( start + 2ms ) == 1 );
+    CHECK( wheel.advance( start + 3ms ) == 1 );
+    CHECK( fired == std::vector<int>{ 1, 3 } );
+
+    CHECK( wheel.advance( start + 69'999ms ) == 0 );
+    CHECK( wheel.advance( start + 70'000ms ) == 1 );
+    CHECK( fired.back() == 70'000 );
+    CHECK( wheel.pending() == 0 );
+}
+
+TEST_CASE( "periodic timers re-arm until joined" )
+{
+    using namespace std::chrono_literals;
+    const auto start = TimerWheel::clock::now();
+    TimerWheel wheel{ 1ms, start };
+    TaskSynchronizer task_sync;
+
+    int ticks = 0;
+    wheel.schedule_every( task_sync, 10ms, [&]{ ++ticks; } );
+    for( int step = 1; step <= 100; ++step )
+        wheel.advance( start + std::chrono::milliseconds{ step } );
+    CHECK( ticks == 10 );
+    CHECK( wheel.pending() == 1 );
+
+    task_sync.join_tasks();
+    CHECK( wheel.pending() == 0 );
+    wheel.advance( start + 1000ms );
+    CHECK( ticks == 10 );
+}
+
+TEST_CASE( "joining cancels the pending timers of its synchronizer only" )
+{
+    using namespace std::chrono_literals;
+    const auto start = TimerWheel::clock::now();
+    TimerWheel wheel{ 1ms, start };
+    TaskSynchronizer joined_sync;
+    TaskSynchronizer other_sync;
+
+    int joined_count = 0;
+    int other_count = 0;
+    for( int index = 0; index < 1000; ++index )
+    {
+        wheel.schedule_after( joined_sync, std::chrono::milliseconds{ index }, [&]{ ++joined_count; } );
+        wheel.schedule_after( other_sync, std::chrono::milliseconds{ index }, [&]{ ++other_count; } );
+    }
+    CHECK( wheel.pending() == 2000 );
+
+    joined_sync.reset();
+    CHECK( wheel.pending() == 1000 );
+    wheel.schedule_after( joined_sync, 5ms, [&]{ ++joined_count; } ); // After reset(), timers work again.
+
+    CHECK( wheel.advance( start + 2000ms ) == 1001 );
+    CHECK( joined_count == 1 );
+    CHECK( other_count == 1000 );
+
+    joined_sync.join_tasks();
+    wheel.schedule_after( joined_sync, 1ms, [&]{ ++joined_count; } ); // Already joined: never scheduled.
+    CHECK( wheel.pending() == 0 );
+}
+
+TEST_CASE( "joining from another thread waits for a firing timer" )
+{
+    using namespace std::chrono_literals;
+    const auto start = TimerWheel::clock::now();
+    TimerWheel wheel{ 1ms, start };
+    TaskSynchronizer task_sync;
+
+    std::atomic<bool> firing{ false };
+    std::atomic<bool> joined{ false };
+    bool fired_before_join = false;
+    wheel.schedule_every( task_sync, 1ms, [&]{
+        firing = true;
+        std::this_thread::sleep_for( 50ms );
+        fired_before_join = !joined;
+    } );
+
+    auto join = std::async( std::launch::async, [&]{
+        wait_condition( [&]{ return firing.load(); } );
+        task_sync.join_tasks();
+        joined = true;
+    } );
+    wheel.advance( start + 1ms );
+    join.wait();
+
+    CHECK( fired_before_join );
+    CHECK( wheel.pending() == 0 );
+}
+
+TEST_CASE( "signals only call the subscribers which are not joined" )
+{
+    Signal<int> signal;
+    TaskSynchronizer first_sync;
+    TaskSynchronizer second_sync;
+
+    int first_sum = 0;
+    int second_sum = 0;
+    signal.connect( first_sync, [&]( int value ) { first_sum += value; } );
+    signal.connect( second_sync, [&]( int value ) { second_sum += value; } );
+    signal.connect( second_sync, [&]( int value ) { second_sum += 10 * value; } );
+    CHECK( signal.size() == 3 );
+
+    signal.emit( 1 );
+    CHECK( first_sum == 1 );
+    CHECK( second_sum == 11 );
+
+    second_sync.reset();
+    CHECK( signal.size() == 1 );
+    signal.emit( 2 );
+    CHECK( first_sum == 3 );
+    CHECK( second_sum == 11 );
+
+    signal.connect( second_sync, [&]( int value ) { second_sum += value; } ); // After reset(), connecting works again.
+    signal.disconnect( first_sync );
+    signal.emit( 3 );
+    CHECK( first_sum == 3 );
+    CHECK( second_sum == 14 );
+
+    second_sync.join_tasks();
+    signal.connect( second_sync, [&]( int value ) { second_sum += value; } ); // Already joined: dropped.
+    CHECK( signal.size() == 0 );
+}
+
+TEST_CASE( "signals can be emitted while subscribers join" )
+{
+    Signal<> signal;
+    std::atomic<int> calls{ 0 };
+    std::vector<std::unique_ptr<TaskSynchronizer>> subscribers;
+    for( int index = 0; index < 100; ++index )
+    {
+        subscribers.push_back( std::make_unique<TaskSynchronizer>() );
+        signal.connect( *subscribers.back(), [&]{ ++calls; } );
+    }
+
+    std::atomic<bool> done{ false };
+    auto emitter = std::async( std::launch::async, [&]{
+        while( !done )
+            signal.emit();
+    } );
+    wait_condition( [&]{ return calls > 0; } );
+    subscribers.clear();
+    done = true;
+    emitter.wait();
+
+    CHECK( signal.size() == 0 );
+    const auto final_calls = calls.load();
+    signal.emit();
+    CHECK( calls == final_calls );
+}
+
+TEST_CASE( "task groups wait for their subtasks" )
+{
+    TaskSynchronizer task_sync;
+    TaskGroup group{ task_sync };
+    std::vector<std::future<void>> threads;
+    const auto thread_executor = [&]( auto subtask ) { threads.push_back( std::async( std::launch::async, std::move( subtask ) ) ); };
+
+    std::atomic<int> ended{ 0 };
+    for( int index = 0; index < 8; ++index )
+        group.spawn( thread_executor, [&]{ std::this_thread::sleep_for( std::chrono::milliseconds{ 10 } ); ++ended; } );
+    group.wait();
+    CHECK( ended == 8 );
+    CHECK( group.pending() == 0 );
+
+    group.spawn( thread_executor, []{ throw 42; } );
+    group.spawn( thread_executor, [&]{ ++ended; } );
+    CHECK_THROWS_AS( group.wait(), int );
+    CHECK( ended == 9 );
+    CHECK_NOTHROW( group.wait() );
+}
+
+TEST_CASE( "joining skips the subtasks which did not start" )
+{
+    TaskSynchronizer task_sync;
+    TaskGroup group{ task_sync };
+    std::vector<std::function<void()>> queue;
+    const auto queue_executor = [&]( auto subtask ) { queue.push_back( std::move( subtask ) ); };
+
+    int executed = 0;
+    group.spawn( queue_executor, [&]{ ++executed; } );
+    group.spawn( queue_executor, [&]{ ++executed; } );
+    queue[ 0 ]();
+    CHECK( group.pending() == 1 );
+
+    task_sync.join_tasks();
+    queue[ 1 ]();
+    CHECK( group.pending() == 0 );
+    group.wait();
+    CHECK( executed == 1 );
+}
+
+TEST_CASE( "task groups do not wait for the subtasks dropped by their executor" )
+{
+    TaskSynchronizer task_sync;
+    TaskGroup group{ task_sync };
+    std::vector<std::function<void()>> queue;
+    const auto queue_executor = [&]( auto subtask ) { queue.push_back( std::move( subtask ) ); };
+    const auto failing_executor = []( auto ) { throw std::runtime_error{ "shutting down" }; };
+
+    int executed = 0;
+    group.spawn( queue_executor, [&]{ ++executed; } );
+    CHECK_THROWS_AS( group.spawn( failing_executor, [&]{ ++executed; } ), std::runtime_error );
+    CHECK( group.pending() == 1 );
+
+    queue.clear(); // Shutting down without executing it.
+    CHECK( group.pending() == 0 );
+    group.wait();
+    CHECK( executed == 0 );
+}
+
+TEST_CASE( "parallel_for processes every item" )
+{
+    TaskSynchronizer task_sync;
+    std::mutex threads_mutex;
+    std::vector<std::future<void>> threads;
+    const auto thread_executor = [&]( auto helper ) {
+        std::scoped_lock lock{ threads_mutex };
+        threads.push_back( std::async( std::launch::async, std::move( helper ) ) );
+    };
+
+    std::atomic<int64_t> sum{ 0 };
+    CHECK( parallel_for( task_sync, thread_executor, 0, 100'000, [&]( int index ) { sum += index; }, 4 ) );
+    CHECK( sum == int64_t{ 99'999 } * 100'000 / 2 );
+
+    std::vector<int> values( 1000, 1 );
+    CHECK( parallel_for( task_sync, thread_executor, values, []( int& value ) { value *= 2; }, 4 ) );
+    CHECK( std::all_of( values.begin(), values.end(), []( int value ) { return value == 2; } ) );
+
+    CHECK_THROWS_AS( parallel_for( task_sync, thread_executor, 0, 100, []( int index ) { if( index == 50 ) throw index; }, 4 ), int );
+}
+
+TEST_CASE( "parallel_for does not wait for helpers which did not start" )
+{
+    TaskSynchronizer task_sync;
+    std::vector<std::function<void()>> queue;
+    const auto queue_executor = [&]( auto helper ) { queue.push_back( std::move( helper ) ); };
+
+    int processed = 0;
+    CHECK( parallel_for( task_sync, queue_executor, 0, 1000, [&]( int ) { ++processed; }, 4 ) );
+    CHECK( processed == 1000 );
+    CHECK( queue.size() == 3 );
+    for( auto& helper : queue )
+        helper(); // Nothing left to do.
+    CHECK( processed == 1000 );
+}
+
+TEST_CASE( "joining stops parallel_for at the next chunk" )
+{
+    TaskSynchronizer task_sync;
+    const auto join_requested = task_sync.get_stop_token();
+    std::future<void> join;
+
+    int processed = 0;
+    const auto completed = parallel_for( task_sync, []( auto ) {}, 0, 1'000'000, [&]( int index ) {
+        ++processed;
+        if( index == 10 )
+        {
+            join = std::async( std::launch::async, [&]{ task_sync.join_tasks(); } );
+            wait_condition( [&]{ return join_requested.stop_requested(); } );
+        }
+    }, 1 );
+    join.wait();
+
+    CHECK_FALSE( completed );
+    CHECK( processed > 10 );
+    CHECK( processed < 1'000'000 );
+    CHECK( task_sync.is_joined() );
+}
+
+namespace {
+
+    /// Sender completing with a value as soon as started.
+    struct JustSender
+    {
+        int value;
+
+        template< class Receiver >
+        struct Operation
+        {
+            int value;
+            Receiver receiver;
+
+            void start() & noexcept { std::move( receiver ).set_value( value ); }
+        };
+
+        template< class Receiver >
+        Operation<Receiver> connect( Receiver receiver ) && { return { value, std::move( receiver ) }; }
+    };
+
+    /// Sender queuing its completion, which happens once the queue is drained.
+    struct QueuedSender
+    {
+        std::vector<std::function<void()>>* queue;
+
+        template< class Receiver >
+        struct Operation
+        {
+            std::vector<std::function<void()>>* queue;
+            Receiver receiver;
+
+            void start() & noexcept { queue->push_back( [this]{ std::move( receiver ).set_value(); } ); }
+        };
+
+        template< class Receiver >
+        Operation<Receiver> connect( Receiver receiver ) && { return { queue, std::move( receiver ) }; }
+    };
+
+    /// Sender which cannot be connected, like when its operation cannot be allocated.
+    struct UnconnectableSender
+    {
+        template< class Receiver >
+        struct Operation
+        {
+            void start() & noexcept {}
+        };
+
+        template< class Receiver >
+        Operation<Receiver> connect( Receiver ) && { throw std::runtime_error{ "cannot connect" }; }
+    };
+
+    struct Completion
+    {
+        std::optional<int> value;
+        bool stopped = false;
+    };
+
+    struct RecordingReceiver
+    {
+        Completion* completion;
+
+        void set_value() && noexcept { completion->value = 0; }
+        void set_value( int value ) && noexcept { completion->value = value; }
+        void set_error( std::exception_ptr ) && noexcept {}
+        void set_stopped() && noexcept { completion->stopped = true; }
+    };
+
+}
+
+TEST_CASE( "synchronized senders are stopped once joined" )
+{
+    TaskSynchronizer task_sync;
+
+    Completion completion;
+    auto operation = synchronized( task_sync, JustSender{ 42 } ).connect( RecordingReceiver{ &completion } );
+    operation.start();
+    CHECK( completion.value == 42 );
+    CHECK_FALSE( completion.stopped );
+
+    Completion joined_completion;
+    auto joined_operation = ( JustSender{ 42 } | synchronized( task_sync ) ).connect( RecordingReceiver{ &joined_completion } );
+    task_sync.join_tasks();
+    joined_operation.start();
+    CHECK_FALSE( joined_completion.value );
+    CHECK( joined_completion.stopped );
+}
+
+TEST_CASE( "async scopes tell when spawned work drained" )
+{
+    TaskSynchronizer task_sync;
+    AsyncScope scope{ task_sync };
+    std::vector<std::function<void()>> queue;
+
+    Completion empty_at_start;
+    auto empty_operation = scope.on_empty().connect( RecordingReceiver{ &empty_at_start } );
+    empty_operation.start();
+    CHECK( empty_at_start.value );
+
+    scope.spawn( QueuedSender{ &queue } );
+    scope.spawn( QueuedSender{ &queue } );
+    scope.spawn( JustSender{ 1 } );
+    CHECK( scope.pending() == 2 );
+
+    Completion drained;
+    auto drained_operation = scope.on_empty().connect( RecordingReceiver{ &drained } );
+    drained_operation.start();
+    queue[ 0 ]();
+    CHECK_FALSE( drained.value );
+    queue[ 1 ]();
+    CHECK( drained.value );
+    CHECK( scope.pending() == 0 );
+
+    task_sync.join_tasks();
+    scope.spawn( QueuedSender{ &queue } ); // Stopped without starting.
+    CHECK( queue.size() == 2 );
+    CHECK( scope.pending() == 0 );
+}
+
+TEST_CASE( "async scopes do not count the senders failing to connect" )
+{
+    TaskSynchronizer task_sync;
+    AsyncScope scope{ task_sync };
+
+    CHECK_THROWS_AS( scope.spawn( UnconnectableSender{} ), std::runtime_error );
+    CHECK( scope.pending() == 0 );
+    Completion empty;
+    auto empty_operation = scope.on_empty().connect( RecordingReceiver{ &empty } );
+    empty_operation.start();
+    CHECK( empty.value );
+}
+
+TEST_CASE( "submitted tasks resolve with their result or as cancelled" )
+{
+    TaskSynchronizer task_sync;
+    std::vector<std::function<void()>> queue;
+    const auto queue_executor = [&]( auto task ) { queue.push_back( std::move( task ) ); };
+
+    auto answer = submit( queue_executor, task_sync, []{ return std::string{ "42" }; } );
+    auto nothing = submit( queue_executor, task_sync, []{} );
+    auto failure = submit( queue_executor, task_sync, []() -> int { throw 42; } );
+    CHECK_FALSE( answer.is_ready() );
+
+    for( auto& task : queue )
+        task();
+    CHECK( answer.wait() == TaskOutcome::value );
+    CHECK( answer.get() == "42" );
+    CHECK( nothing.wait() == TaskOutcome::value );
+    nothing.get();
+    CHECK( failure.wait() == TaskOutcome::exception );
+    CHECK_THROWS_AS( failure.get(), int );
 
+    queue.clear();
+    auto skipped = submit( queue_executor, task_sync, []{ return 1; } );
+    auto dropped = submit( queue_executor, task_sync, []{ return 2; } );
+    task_sync.join_tasks();
+    queue[ 0 ]();
+    CHECK( skipped.wait() == TaskOutcome::cancelled );
+    CHECK_THROWS_AS( skipped.get(), TaskCancelled );
+    CHECK_FALSE( dropped.is_ready() );
+    queue.clear(); // The executor drops the task without executing it.
+    CHECK( dropped.wait() == TaskOutcome::cancelled );
+    CHECK_THROWS_AS( dropped.get(), TaskCancelled );
+}
+
+TEST_CASE( "submitted tasks can be waited for from other threads" )
+{
+    TaskSynchronizer task_sync;
+    std::vector<std::future<void>> threads;
+    const auto thread_executor = [&]( auto task ) { threads.push_back( std::async( std::launch::async, std::move( task ) ) ); };
+
+    std::vector<TaskHandle<int>> handles;
+    for( int index = 0; index < 16; ++index )
+        handles.push_back( submit( thread_executor, task_sync, [index]{ return index; } ) );
+
+    int sum = 0;
+    for( auto& handle : handles )
+        sum += handle.get();
+    CHECK( sum == 120 );
+}
+
+TEST_CASE( "chains pass the result of each step to the next one" )
+{
+    TaskSynchronizer task_sync;
+    std::vector<int> persisted;
+    const auto chain = task_sync.chain( []( const std::string& text ) { return std::make_unique<int>( std::stoi( text ) ); } )
+        .then( []( std::unique_ptr<int> value ) { return *value * 2; } )
+        .then( [&]( int value ) { persisted.push_back( value ); } )
+        .then( [&]{ persisted.push_back( -1 ); } );
+    static_assert( decltype( chain )::size() == 4 );
+
+    CHECK( chain( "21" ) );
+    CHECK( chain( std::string{ "1" } ) );
+    CHECK( persisted == std::vector<int>{ 42, -1, 2, -1 } );
+
+    task_sync.join_tasks();
+    CHECK_FALSE( chain( "3" ) );
+    CHECK( persisted.size() == 4 );
+}
+
+TEST_CASE( "posted chains stop at the next hop once joined" )
+{
+    TaskSynchronizer task_sync;
+    std::vector<std::function<void()>> queue;
+    const auto queue_executor = [&]( auto task ) { queue.push_back( std::move( task ) ); };
+    const auto run_queue = [&] {
+        auto tasks = std::move( queue );
+        queue.clear();
+        for( auto& task : tasks )
+            task();
+        return tasks.size();
+    };
+
+    std::vector<std::string> steps;
+    const auto chain = task_sync.chain( [&]( int value ) { steps.push_back( "parse" ); return value + 1; } )
+        .then( [&]( int value ) { steps.push_back( "validate" ); return std::to_string( value ); } )
+        .then( [&]( std::string value ) { steps.push_back( "persist " + value ); } );
+
+    chain.post( queue_executor, 1 );
+    while( run_queue() > 0 ) {}
+    CHECK( steps == std::vector<std::string>{ "parse", "validate", "persist 2" } );
+
+    steps.clear();
+    chain.post( queue_executor, 2 );
+    CHECK( run_queue() == 1 );
+    task_sync.join_tasks();
+    CHECK( run_queue() == 1 ); // Skipped, the chain ends without posting the next hop.
+    CHECK( queue.empty() );
+    CHECK( steps == std::vector<std::string>{ "parse" } );
+}
+
+TEST_CASE( "posted chains release their state when the executor drops or fails to post a hop" )
+{
+    TaskSynchronizer task_sync;
+    std::vector<std::function<void()>> queue;
+    const auto queue_executor = [&]( auto task ) { queue.push_back( std::move( task ) ); };
+    const auto failing_executor = []( auto ) { throw std::runtime_error{ "shutting down" }; };
+
+    const auto chain = task_sync.chain( []( std::shared_ptr<int> value ) { return value; } )
+        .then( []( std::shared_ptr<int> ) {} );
+    auto input = std::make_shared<int>( 1 );
+    chain.post( queue_executor, input );
+    CHECK( input.use_count() == 2 );
+    queue.clear(); // Shutting down without executing it.
+    CHECK( input.use_count() == 1 );
+
+    CHECK_THROWS_AS( chain.post( failing_executor, input ), std::runtime_error );
+    CHECK( input.use_count() == 1 );
+}
+
+TEST_CASE( "chains built once can be posted from multiple threads" )
+{
+    TaskSynchronizer task_sync;
+    std::atomic<int> sum{ 0 };
+    std::mutex threads_mutex;
+    std::vector<std::future<void>> threads;
+    const auto thread_executor = [&]( auto task ) {
+        std::scoped_lock lock{ threads_mutex };
+        threads.push_back( std::async( std::launch::async, std::move( task ) ) );
+    };
+
+    const auto chain = task_sync.chain( []( int value ) { return value * 2; } )
+        .then( [&]( int value ) { sum += value; } );
+    for( int index = 0; index < 8; ++index )
+        chain.post( thread_executor, index );
+
+    wait_condition( [&]{ return sum == 56; } );
+    std::scoped_lock lock{ threads_mutex };
+    for( auto& thread : threads )
+        thread.wait();
+}
+
+#if defined(__linux__)
+
+namespace {
+    /// Both ends of a non-blocking pipe or stream socket pair, closed on destruction.
+    struct Channel
+    {
+        int ends[ 2 ] = { -1, -1 };
+
+        explicit Channel( bool socket )
+        {
+            const int result = socket ? ::socketpair( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, ends )
+                                      : ::pipe2( ends, O_NONBLOCK | O_CLOEXEC );
+            REQUIRE( result == 0 );
+        }
+
+        ~Channel()
+        {
+            ::close( ends[ 0 ] );
+            ::close( ends[ 1 ] );
+        }
+
+        int reader() const { return ends[ 0 ]; }
+        int writer() const { return ends[ 1 ]; }
+    };
+
+    std::vector<ReactorBackend> reactor_backends()
+    {
+#if TASKSYNC_IO_URING
+        return { ReactorBackend::epoll, ReactorBackend::io_uring };
+#else
+        return { ReactorBackend::epoll };
+#endif
+    }
+}
+
+TEST_CASE( "reactor operations complete once their descriptor is ready" )
+{
+    for( const auto backend : reactor_backends() )
+        for( const bool socket : { false, true } )
+        {
+            Reactor reactor{ backend };
+            TaskSynchronizer task_sync;
+            Channel channel{ socket };
+
+            std::array<std::byte, 16> buffer{};
+            ssize_t read_result = 0;
+            CHECK( reactor.async_read( task_sync, channel.reader(), buffer, [&]( ssize_t result ) { read_result = result; } ) );
+            CHECK( reactor.run_once( std::chrono::milliseconds{ 0 } ) == 0 );
+
+            const std::string message = "hello";
+            ssize_t write_result = 0;
+            CHECK( reactor.async_write( task_sync, channel.writer(), std::as_bytes( std::span{ message } ),
+                                        [&]( ssize_t result ) { write_result = result; } ) );
+            CHECK( reactor.pending() == 2 );
+
+            std::size_t ended = 0;
+            while( ended < 2 )
+                ended += reactor.run_once( std::chrono::milliseconds{ 1000 } );
+            CHECK( write_result == 5 );
+            CHECK( read_result == 5 );
+            CHECK( std::string( reinterpret_cast<const char*>( buffer.data() ), 5 ) == message );
+
+            bool closed = false;
+            ::close( std::exchange( channel.ends[ 1 ], -1 ) );
+            CHECK( reactor.async_read( task_sync, channel.reader(), buffer, [&]( ssize_t result ) { closed = result == 0; } ) );
+            CHECK( reactor.run_once() == 1 );
+            CHECK( closed );
+            CHECK( reactor.pending() == 0 );
+        }
+}
+
+TEST_CASE( "joining cancels the pending reactor operations of its synchronizer only" )
+{
+    for( const auto backend : reactor_backends() )
+        for( const bool socket : { false, true } )
+        {
+            Reactor reactor{ backend };
+            TaskSynchronizer joined;
+            TaskSynchronizer other;
+            Channel channel{ socket };
+            Channel other_channel{ socket };
+
+            std::array<std::byte, 4> buffer{};
+            bool cancelled_called = false;
+            bool other_called = false;
+            CHECK( reactor.async_read( joined, channel.reader(), buffer, [&]( ssize_t ) { cancelled_called = true; } ) );
+            CHECK( reactor.async_wait( other, other_channel.reader(), ReactorDirection::read, [&]{ other_called = true; } ) );
+            CHECK( reactor.pending() == 2 );
+
+            joined.join_tasks();
+            CHECK( reactor.pending() == 1 );
+            CHECK_FALSE( reactor.async_wait( joined, channel.writer(), ReactorDirection::write, [&]{ cancelled_called = true; } ) );
+
+            CHECK( ::write( channel.writer(), "data", 4 ) == 4 );
+            CHECK( ::write( other_channel.writer(), "data", 4 ) == 4 );
+            while( !other_called )
+                reactor.run_once( std::chrono::milliseconds{ 1000 } );
+            reactor.run_once( std::chrono::milliseconds{ 10 } );
+            CHECK_FALSE( cancelled_called );
+            CHECK( ::read( channel.reader(), buffer.data(), buffer.size() ) == 4 ); // Never read by the cancelled operation.
+            CHECK( reactor.pending() == 0 );
+        }
+}
+
+TEST_CASE( "joining waits for the reactor handler being executed" )
+{
+    for( const auto backend : reactor_backends() )
+    {
+        Reactor reactor{ backend };
+        TaskSynchronizer task_sync;
+        Channel channel{ true };
+
+        std::promise<void> handler_end;
+        std::atomic<bool> handler_started{ false };
+        CHECK( reactor.async_wait( task_sync, channel.writer(), ReactorDirection::write, [&]{
+            handler_started = true;
+            handler_end.get_future().wait();
+        } ) );
+        auto reactor_thread = std::async( std::launch::async, [&]{ return reactor.run_once(); } );
+        wait_condition( [&]{ return handler_started.load(); } );
+
+        auto join = std::async( std::launch::async, [&]{ task_sync.join_tasks(); } );
+        CHECK( join.wait_for( std::chrono::milliseconds( 10 ) ) == std::future_status::timeout );
+        handler_end.set_value();
+        join.get();
+        CHECK( reactor_thread.get() == 1 );
+    }
+}
+
+TEST_CASE( "reactors drop their pending operations when destroyed" )
+{
+    for( const auto backend : reactor_backends() )
+    {
+        TaskSynchronizer task_sync;
+        Channel channel{ false };
+        std::array<std::byte, 4> buffer{};
+        {
+            Reactor reactor{ backend };
+            CHECK( reactor.async_read( task_sync, channel.reader(), buffer, []( ssize_t ) {} ) );
+        }
+        task_sync.join_tasks();
+    }
+}
+
+#endif
+
+#if defined(__linux__)
+
+namespace {
+    std::string shared_memory_name( const char* test )
+    {
+        return "/tasksync-tests-" + std::string{ test } + "-" + std::to_string( ::getpid() );
+    }
+}
+
+TEST_CASE( "shared synchronizers skip the tasks of workers once joined or reset" )
+{
+    SharedTaskSynchronizer owner{ shared_memory_name( "skip" ), 1 };
+    SharedTaskWorker worker{ owner.name() };
+    CHECK_THROWS_AS( SharedTaskWorker{ owner.name() }, std::system_error ); // Its only slot is taken.
+
+    int count = 0;
+    auto task = worker.synchronized( [&]{ ++count; } );
+    task();
+    CHECK( count == 1 );
+
+    owner.reset();
+    task();
+    CHECK( count == 1 );
+    auto next_task = worker.synchronized( [&]( int increment ) { count += increment; } );
+    next_task( 2 );
+    CHECK( count == 3 );
+
+    owner.join_tasks();
+    CHECK( worker.is_join_requested() );
+    CHECK( owner.is_joined() );
+    next_task( 2 );
+    CHECK( count == 3 );
+}
+
+TEST_CASE( "joining a shared synchronizer waits for the tasks of other processes" )
+{
+    SharedTaskSynchronizer owner{ shared_memory_name( "join" ) };
+    int started[ 2 ];
+    REQUIRE( ::pipe( started ) == 0 );
+
+    const auto child = fork_child( [&] {
+        SharedTaskWorker worker{ owner.name() };
+        bool executed = false;
+        worker.synchronized( [&] {
+            CHECK( ::write( started[ 1 ], "s", 1 ) == 1 );
+            std::this_thread::sleep_for( std::chrono::milliseconds{ 100 } );
+            executed = true;
+        } )();
+        while( !worker.is_join_requested() )
+            std::this_thread::sleep_for( std::chrono::milliseconds{ 1 } );
+        bool skipped = true;
+        worker.synchronized( [&]{ skipped = false; } )();
+        return executed && skipped ? EXIT_SUCCESS : EXIT_FAILURE;
+    } );
+
+    char signal = 0;
+    REQUIRE( ::read( started[ 0 ], &signal, 1 ) == 1 );
+    CHECK( owner.running_tasks() == 1 );
+    const auto join_begin = std::chrono::steady_clock::now();
+    owner.join_tasks();
+    CHECK( std::chrono::steady_clock::now() - join_begin >= std::chrono::milliseconds{ 50 } );
+    CHECK( owner.running_tasks() == 0 );
+    CHECK( wait_child( child ) == EXIT_SUCCESS );
+    CHECK( owner.crashed_workers() == 0 );
+    ::close( started[ 0 ] );
+    ::close( started[ 1 ] );
+}
+
+TEST_CASE( "joining a shared synchronizer does not wait for crashed workers" )
+{
+    SharedTaskSynchronizer owner{ shared_memory_name( "crash" ) };
+    int started[ 2 ];
+    REQUIRE( ::pipe( started ) == 0 );
+
+    const auto child = fork_child( [&] {
+        SharedTaskWorker worker{ owner.name() };
+        worker.synchronized( [&] {
+            CHECK( ::write( started[ 1 ], "s", 1 ) == 1 );
+            ::_exit( 3 ); // Crashes in the middle of the task.
+        } )();
+        return EXIT_SUCCESS;
+    } );
+
+    char signal = 0;
+    REQUIRE( ::read( started[ 0 ], &signal, 1 ) == 1 );
+    owner.join_tasks(); // The child is not reaped yet.
+    CHECK( owner.crashed_workers() == 1 );
+    CHECK( owner.running_tasks() == 0 );
+    CHECK( wait_child( child ) == 3 );
+
+    owner.reset();
+    SharedTaskWorker worker{ owner.name() };
+    bool executed = false;
+    worker.synchronized( [&]{ executed = true; } )();
+    CHECK( executed );
+    ::close( started[ 0 ] );
+    ::close( started[ 1 ] );
+}
+
+TEST_CASE( "a process reusing the pid of a crashed shared worker is not taken for it" )
+{
+    const auto pid = static_cast<int32_t>( ::getpid() );
+    const auto start_time = details::process_start_time( pid );
+    REQUIRE( start_time != 0 );
+    CHECK_FALSE( details::process_ended( pid, start_time ) );
+    CHECK_FALSE( details::process_ended( pid, 0 ) ); // Unknown start time: only the pid is checked.
+    CHECK( details::process_ended( pid, start_time + 1 ) ); // As if the worker had this pid before this process.
+}
+
+#endif
+
+TEST_CASE( "pipelines hand all the items through their stages, in order" )
+{
+    std::vector<std::string> received;
+    {
+        auto pipeline = tasksync::pipeline<int>( 8,
+            []( int item ) { return item * 2; },
+            []( int item ) { return std::to_string( item ); },
+            [&]( std::string item ) { received.push_back( std::move( item ) ); } );
+        CHECK( pipeline.capacity() == 8 );
+        CHECK( decltype( pipeline )::size() == 3 );
+
+        for( int item = 0; item < 500; ++item ) // Far more than the queues hold: pushing waits for the stages.
+            CHECK( pipeline.push( item ) );
+        std::vector<int> batch{ 500, 501, 502 };
+        CHECK( pipeline.push( std::span{ batch } ) == 3 );
+        pipeline.finish();
+        CHECK( !pipeline.push( 0 ) );
+    }
+
+    REQUIRE( received.size() == 503 );
+    for( int item = 0; item < 503; ++item )
+        CHECK( received[ static_cast<std::size_t>( item ) ] == std::to_string( item * 2 ) );
+}
+
+TEST_CASE( "joining a pipeline stops its stages from upstream to downstream, with bounded items in flight" )
+{
+    constexpr std::size_t capacity = 4;
+    std::atomic<int64_t> processed{ 0 };
+    auto pipeline = tasksync::pipeline<int64_t>( capacity,
+        []( int64_t item ) { return item; },
+        []( int64_t item ) { return item; },
+        [&]( int64_t ) {
+            std::this_thread::sleep_for( std::chrono::microseconds{ 200 } );
+            ++processed;
+        } );
+
+    std::vector<int> join_order; // Stop is requested when joining begins.
+    auto on_join = [&]( int stage ) { return [ &join_order, stage ]{ join_order.push_back( stage ); }; };
+    std::stop_callback on_join_0{ pipeline.synchronizer<0>().get_stop_token(), on_join( 0 ) };
+    std::stop_callback on_join_1{ pipeline.synchronizer<1>().get_stop_token(), on_join( 1 ) };
+    std::stop_callback on_join_2{ pipeline.synchronizer<2>().get_stop_token(), on_join( 2 ) };
+
+    std::atomic<int64_t> pushed{ 0 };
+    std::thread producer{ [&] {
+        while( pipeline.push( pushed.load() ) )
+            ++pushed;
+    } };
+    std::this_thread::sleep_for( std::chrono::milliseconds{ 20 } );
+    // A slow last stage holds the producer back: each stage holds at most its queue, a batch and its results.
+    CHECK( pushed - processed <= static_cast<int64_t>( 3 * 3 * capacity ) );
+
+    pipeline.join();
+    producer.join(); // Pushing returned false.
+    CHECK( join_order == std::vector<int>{ 0, 1, 2 } );
+    CHECK( pipeline.synchronizer<0>().is_joined() );
+    CHECK( pipeline.synchronizer<2>().is_joined() );
+    const auto processed_at_join = processed.load();
+    std::this_thread::sleep_for( std::chrono::milliseconds{ 5 } );
+    CHECK( processed == processed_at_join );
+}
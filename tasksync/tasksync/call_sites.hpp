@@ -0,0 +1,143 @@
+#pragma once
+
+#include <tasksync/config.hpp>
+#include <tasksync/stats.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <source_location>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace tasksync {
+
+    /** Activity of the tasks wrapped by one call site of TaskSynchronizer::synchronized().
+        @see call_site_stats()
+    */
+    struct CallSiteStats
+    {
+        /// Location of the synchronized() call which wrapped the tasks.
+        std::source_location location;
+
+        /// Number of task bodies wrapped at this location which were executed.
+        int64_t executed_tasks = 0;
+
+        /// Number of tasks wrapped at this location which were invoked after their synchronizer was joined or destroyed.
+        int64_t skipped_tasks = 0;
+
+        /// Cumulative time spent executing tasks wrapped at this location while their synchronizer was waiting to join them.
+        std::chrono::nanoseconds time_under_join{ 0 };
+    };
+
+    namespace details {
+
+        /** Counters of one synchronized() call site, which lives as long as the program. */
+        class call_site
+        {
+        public:
+            explicit call_site( const std::source_location& location ) : m_location( location ) {}
+
+            const std::source_location& location() const { return m_location; }
+
+            void count_executed() { m_counters.add( executed ); }
+            void count_skipped() { m_counters.add( skipped ); }
+            void count_time_under_join( std::chrono::nanoseconds duration ) { m_counters.add( under_join_ns, duration.count() ); }
+
+            CallSiteStats snapshot() const
+            {
+                CallSiteStats stats;
+                stats.location = m_location;
+                stats.executed_tasks = m_counters.sum( executed );
+                stats.skipped_tasks = m_counters.sum( skipped );
+                stats.time_under_join = std::chrono::nanoseconds{ m_counters.sum( under_join_ns ) };
+                return stats;
+            }
+
+        private:
+            std::source_location m_location;
+
+            enum : std::size_t { executed, skipped, under_join_ns, counter_count };
+            sharded_counters<counter_count> m_counters;
+        };
+
+        /** Process-wide set of the synchronized() call sites which wrapped at least one task. */
+        class call_site_registry
+        {
+        public:
+
+            static call_site_registry& instance()
+            {
+                static call_site_registry registry;
+                return registry;
+            }
+
+            /** @return The counters of the provided location, created on first use.
+
+                Each thread caches the call sites it already looked up, so that the shared registry
+                is only locked the first time a thread wraps a task at a given location.
+            */
+            call_site& find( const std::source_location& location )
+            {
+                thread_local std::unordered_map<LocalKey, call_site*, LocalKeyHash> local_sites;
+
+                const LocalKey local_key{ location.file_name(), location.line(), location.column() };
+                if( auto it = local_sites.find( local_key ); it != local_sites.end() )
+                    return *it->second;
+
+                std::scoped_lock lock{ m_mutex };
+                const Key key{ location.file_name(), location.line(), location.column() };
+                auto it = m_index.find( key );
+                if( it == m_index.end() )
+                    it = m_index.emplace( key, &m_sites.emplace_back( location ) ).first;
+
+                local_sites.emplace( local_key, it->second );
+                return *it->second;
+            }
+
+            std::vector<CallSiteStats> snapshot()
+            {
+                std::scoped_lock lock{ m_mutex };
+                std::vector<CallSiteStats> stats;
+                stats.reserve( m_sites.size() );
+                for( const auto& site : m_sites )
+                    stats.push_back( site.snapshot() );
+                return stats;
+            }
+
+        private:
+
+            // The same location can have several file name addresses when it's in a header used by several translation units.
+            using Key = std::tuple<std::string_view, uint_least32_t, uint_least32_t>;
+            using LocalKey = std::tuple<const char*, uint_least32_t, uint_least32_t>;
+
+            struct LocalKeyHash
+            {
+                std::size_t operator()( const LocalKey& key ) const
+                {
+                    const auto [ file, line, column ] = key;
+                    return std::hash<const char*>{}( file ) ^ ( std::size_t{ line } << 16 ) ^ column;
+                }
+            };
+
+            std::mutex m_mutex;
+            std::deque<call_site> m_sites; // Never shrinks, so that references stay valid.
+            std::map<Key, call_site*> m_index;
+        };
+
+    }
+
+    /** @return The activity of the tasks wrapped by each synchronized() call site so far, from all synchronizers.
+        Only available if `TASKSYNC_CALL_SITES` is enabled (`config.tasksync.call_sites`).
+    */
+    inline std::vector<CallSiteStats> call_site_stats()
+    {
+        return details::call_site_registry::instance().snapshot();
+    }
+
+}
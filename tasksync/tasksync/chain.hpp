@@ -0,0 +1,257 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace tasksync {
+
+    namespace details {
+
+        /// Executes a hop of a chain, as the body of the synchronized task wrapping all the hops of a chain.
+        struct invoke_hop
+        {
+            template< class Hop >
+            void operator()( Hop& hop ) const { hop(); }
+        };
+
+        using synchronized_hop = decltype( std::declval<TaskSynchronizer&>().synchronized( invoke_hop{} ) );
+
+        /** Invoke a step of a chain with its input, a tuple of arguments.
+            @return The output of the step, input of the next one: a tuple of its result, empty if it returns void.
+        */
+        template< class Step, class Input >
+        auto apply_step( Step& step, Input&& input )
+        {
+            using Result = decltype( std::apply( step, std::move( input ) ) );
+            if constexpr( std::is_void_v<Result> )
+            {
+                std::apply( step, std::move( input ) );
+                return std::tuple<>{};
+            }
+            else
+                return std::tuple<std::remove_cvref_t<Result>>{ std::apply( step, std::move( input ) ) };
+        }
+
+        template< class Step, class Input >
+        using step_output = decltype( apply_step( std::declval<Step&>(), std::declval<Input>() ) );
+
+        /// Variant of the inputs of the steps, in order, `std::monostate` first: the value passed between two hops.
+        template< class Variant, class Input, class... Steps >
+        struct chain_inputs { using type = Variant; };
+
+        template< class... Inputs, class Input, class Step, class... Steps >
+        struct chain_inputs<std::variant<Inputs...>, Input, Step, Steps...>
+            : chain_inputs<std::variant<Inputs..., Input>, step_output<const Step, Input>, Steps...>
+        {};
+
+        /** Execution of a chain started with Chain::post(), owned by the hops given to the executor: deleted once
+            the last one is destroyed, whether the chain ended, stopped, or a hop was dropped or lost to an exception.
+        */
+        template< class Steps, class Executor, class Inputs >
+        class chain_run
+        {
+        public:
+            chain_run( std::shared_ptr<const Steps> steps, synchronized_hop synched, Executor executor )
+                : m_steps( std::move( steps ) )
+                , m_synched( std::move( synched ) )
+                , m_executor( std::move( executor ) )
+            {}
+
+            /** Post the first hop. Takes ownership of this run, even if an exception is thrown. */
+            template< class Input >
+            void post( Input&& input )
+            {
+                resume_run first{ this };
+                m_input.template emplace<1>( std::forward<Input>( input ) );
+                m_executor( std::move( first ) );
+            }
+
+        private:
+            /// What the executor receives for each hop: pointer sized, so that it is usually stored without allocating.
+            class resume_run
+            {
+            public:
+                explicit resume_run( chain_run* run ) : m_run( run ) { m_run->m_references.fetch_add( 1, std::memory_order_relaxed ); }
+
+                resume_run( const resume_run& other ) : m_run( other.m_run )
+                {
+                    if( m_run )
+                        m_run->m_references.fetch_add( 1, std::memory_order_relaxed );
+                }
+
+                resume_run( resume_run&& other ) noexcept : m_run( std::exchange( other.m_run, nullptr ) ) {}
+
+                resume_run& operator=( resume_run other ) noexcept
+                {
+                    std::swap( m_run, other.m_run );
+                    return *this;
+                }
+
+                ~resume_run()
+                {
+                    if( m_run && m_run->m_references.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+                        delete m_run;
+                }
+
+                void operator()() const { m_run->resume(); }
+
+            private:
+                chain_run* m_run;
+            };
+
+            static constexpr std::size_t step_count = std::tuple_size_v<Steps>;
+
+            const std::shared_ptr<const Steps> m_steps;
+            synchronized_hop m_synched;
+            Executor m_executor;
+            Inputs m_input;
+            void ( chain_run::*m_hop )() = &chain_run::hop<0>;
+            bool m_posted = false; ///< Whether the next hop must be posted once the current one ended.
+            std::atomic<uint32_t> m_references{ 0 }; ///< Copies of the hops given to the executor.
+
+            void resume()
+            {
+                m_posted = false;
+                auto hop = [this]{ ( this->*m_hop )(); };
+                m_synched( hop );
+                if( m_posted ) // Posted once the hop ended: the next one can start on another thread right away.
+                    m_executor( resume_run{ this } );
+                // Otherwise skipped because joined, or the last step: the chain ends with this hop.
+            }
+
+            template< std::size_t Index >
+            void hop()
+            {
+                auto output = apply_step( std::get<Index>( *m_steps ), std::move( std::get<Index + 1>( m_input ) ) );
+                if constexpr( Index + 1 < step_count )
+                {
+                    m_input.template emplace<Index + 2>( std::move( output ) );
+                    m_hop = &chain_run::hop<Index + 1>;
+                    m_posted = true;
+                }
+            }
+        };
+
+    }
+
+    /** Steps executed one after the other, each one with the result of the previous one, as long as the synchronizer
+        of the chain is not joined. Obtained from TaskSynchronizer::chain(), extended with then().
+
+        Each step is executed as a synchronized task: once a joining function of the synchronizer is called, the chain
+        stops at the next hop, between two steps; the step being executed, if any, is waited for by the join.
+
+        The chain is built once, then invoked any number of times, from any thread: the steps are shared by all the
+        invocations, thus invoked as const (mutable lambdas are rejected), and their results are moved from one
+        step to the next. Invoking a chain allocates nothing;
+        posting it allocates the state of the invocation once, its hops being posted without being wrapped again.
+
+        The first step takes the arguments of the invocation, each next step the value returned by the previous one,
+        or nothing if it returned void. The value returned by the last step is ignored.
+    */
+    template< class... Steps >
+    class Chain
+    {
+    public:
+        /** @return A chain executing `step` with the result of the last step of this one, after it. */
+        template< class Step >
+        Chain<Steps..., std::decay_t<Step>> then( Step&& step ) const &
+        {
+            return { m_synched, std::tuple_cat( *m_steps, std::tuple<std::decay_t<Step>>{ std::forward<Step>( step ) } ) };
+        }
+
+        /** @return A chain executing `step` with the result of the last step of this one, after it. */
+        template< class Step >
+        Chain<Steps..., std::decay_t<Step>> then( Step&& step ) &&
+        {
+            auto step_tuple = std::tuple<std::decay_t<Step>>{ std::forward<Step>( step ) };
+            if( m_steps.use_count() == 1 ) // Not shared with a copy or a posted invocation: the steps can be moved.
+                return { std::move( m_synched ), std::tuple_cat( std::move( *m_steps ), std::move( step_tuple ) ) };
+            return { std::move( m_synched ), std::tuple_cat( *m_steps, std::move( step_tuple ) ) };
+        }
+
+        /** Execute the steps on the calling thread, until the synchronizer is joined.
+            @param args Arguments of the first step.
+            @return true if all the steps were executed, false if a join stopped the chain.
+            Exceptions thrown by steps are propagated, stopping the chain.
+        */
+        template< class... Args >
+        bool operator()( Args&&... args ) const
+        {
+            auto synched = m_synched; // Copied: invoked concurrently by the invocations of the chain.
+            return execute_from<0>( synched, std::forward_as_tuple( std::forward<Args>( args )... ) );
+        }
+
+        /** Submit each step to the executor once the previous one ended, until the synchronizer is joined.
+
+            The executor (any callable taking a callable with no arguments, see TaskGroup) must invoke what it receives
+            at most once: a hop it drops, or loses by throwing, stops the chain. An exception thrown by a step stops
+            the chain and is propagated to the executor.
+            @param args Arguments of the first step, copied.
+        */
+        template< class Executor, class... Args >
+        void post( Executor&& executor, Args&&... args ) const
+        {
+            using Input = std::tuple<std::decay_t<Args>...>;
+            using Inputs = typename details::chain_inputs<std::variant<std::monostate>, Input, Steps...>::type;
+            using Run = details::chain_run<std::tuple<Steps...>, std::decay_t<Executor>, Inputs>;
+
+            auto* run = new Run{ m_steps, m_synched, std::forward<Executor>( executor ) };
+            run->post( Input{ std::forward<Args>( args )... } );
+        }
+
+        /** @return Number of steps of this chain. */
+        static constexpr std::size_t size() { return sizeof...( Steps ); }
+
+    private:
+        friend class TaskSynchronizer;
+        template< class... OtherSteps >
+        friend class Chain;
+
+        Chain( details::synchronized_hop synched, std::tuple<Steps...> steps )
+            : m_synched( std::move( synched ) )
+            , m_steps( std::make_shared<std::tuple<Steps...>>( std::move( steps ) ) )
+        {}
+
+        details::synchronized_hop m_synched;
+        std::shared_ptr<std::tuple<Steps...>> m_steps; ///< Only modified by then() when it is the single owner.
+
+        template< std::size_t Index, class Input >
+        bool execute_from( details::synchronized_hop& synched, Input&& input ) const
+        {
+            // Const, like for post(): the steps are shared by the invocations, which can be concurrent.
+            const auto& step = std::get<Index>( std::as_const( *m_steps ) );
+            if constexpr( Index + 1 < sizeof...( Steps ) )
+            {
+                std::optional<details::step_output<const std::tuple_element_t<Index, std::tuple<Steps...>>, Input>> output;
+                auto hop = [&]{ output.emplace( details::apply_step( step, std::forward<Input>( input ) ) ); };
+                synched( hop );
+                return output && execute_from<Index + 1>( synched, std::move( *output ) );
+            }
+            else
+            {
+                bool executed = false;
+                auto hop = [&]{ executed = true; details::apply_step( step, std::forward<Input>( input ) ); };
+                synched( hop );
+                return executed;
+            }
+        }
+    };
+
+    template< class Step >
+    Chain<std::decay_t<Step>> TaskSynchronizer::chain( Step&& step, details::task_location location )
+    {
+        return { synchronized( details::invoke_hop{}, location ), std::tuple<std::decay_t<Step>>{ std::forward<Step>( step ) } };
+    }
+
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+// Optional features of tasksync.
+//
+// They are all disabled unless enabled through the build configuration
+// (see `build/root.build`), in which case the corresponding macro is exported
+// to users of the library. A disabled feature costs nothing: its data members,
+// functions and hot-path code are compiled out.
+
+#if !defined(TASKSYNC_STATS)
+#   define TASKSYNC_STATS 0
+#endif
+
+// Number of cache-line sized shards the hot-path counters are split in.
+#if !defined(TASKSYNC_STATS_SHARDS)
+#   define TASKSYNC_STATS_SHARDS 8
+#endif
+
+#if !defined(TASKSYNC_HISTOGRAMS)
+#   define TASKSYNC_HISTOGRAMS 0
+#endif
+
+// Default number of task executions of a synchronizer for each one which duration is sampled.
+#if !defined(TASKSYNC_HISTOGRAMS_SAMPLING_RATE)
+#   define TASKSYNC_HISTOGRAMS_SAMPLING_RATE 8
+#endif
+
+// Requires the CPU time clocks of threads of POSIX (CLOCK_THREAD_CPUTIME_ID).
+#if !defined(TASKSYNC_CPU_TIME)
+#   define TASKSYNC_CPU_TIME 0
+#endif
+
+// Default number of task executions of a synchronizer for each one which CPU time and wall time are sampled.
+#if !defined(TASKSYNC_CPU_TIME_SAMPLING_RATE)
+#   define TASKSYNC_CPU_TIME_SAMPLING_RATE 8
+#endif
+
+// Requires C++20 (std::source_location).
+#if !defined(TASKSYNC_CALL_SITES)
+#   define TASKSYNC_CALL_SITES 0
+#endif
+
+#if !defined(TASKSYNC_RUNNING_REGISTRY)
+#   define TASKSYNC_RUNNING_REGISTRY 0
+#endif
+
+// Maximum number of nested running tasks per thread described by the running task registry.
+#if !defined(TASKSYNC_RUNNING_REGISTRY_DEPTH)
+#   define TASKSYNC_RUNNING_REGISTRY_DEPTH 8
+#endif
+
+#if !defined(TASKSYNC_WATCHDOG)
+#   define TASKSYNC_WATCHDOG 0
+#endif
+
+// The watchdog finds slow tasks and joins through the running task registry.
+#if TASKSYNC_WATCHDOG && !TASKSYNC_RUNNING_REGISTRY
+#   undef TASKSYNC_RUNNING_REGISTRY
+#   define TASKSYNC_RUNNING_REGISTRY 1
+#endif
+
+// Static tracing probes, see tasksync/probes.hpp.
+#if !defined(TASKSYNC_SDT)
+#   define TASKSYNC_SDT 0
+#endif
+
+#if !defined(TASKSYNC_TRACE)
+#   define TASKSYNC_TRACE 0
+#endif
+
+// Number of trace events each thread keeps, older ones are overwritten.
+#if !defined(TASKSYNC_TRACE_BUFFER_EVENTS)
+#   define TASKSYNC_TRACE_BUFFER_EVENTS 16384
+#endif
+
+#if !defined(TASKSYNC_REGISTRY)
+#   define TASKSYNC_REGISTRY 0
+#endif
+
+// Number of independently locked parts of the synchronizer registry.
+#if !defined(TASKSYNC_REGISTRY_SHARDS)
+#   define TASKSYNC_REGISTRY_SHARDS 16
+#endif
+
+// The registry exposes the statistics of the synchronizers.
+#if TASKSYNC_REGISTRY && !TASKSYNC_STATS
+#   undef TASKSYNC_STATS
+#   define TASKSYNC_STATS 1
+#endif
+
+#if !defined(TASKSYNC_WRAPPER_ACCOUNTING)
+#   define TASKSYNC_WRAPPER_ACCOUNTING 0
+#endif
+
+// io_uring backend of the Linux reactor, see tasksync/reactor.hpp (needs the kernel headers, Linux 5.11 or later to run).
+#if !defined(TASKSYNC_IO_URING)
+#   define TASKSYNC_IO_URING 0
+#endif
+
+// Interval in milliseconds at which joining a SharedTaskSynchronizer checks whether the workers it waits for crashed.
+#if !defined(TASKSYNC_SHARED_SYNC_LIVENESS_MS)
+#   define TASKSYNC_SHARED_SYNC_LIVENESS_MS 10
+#endif
+
+// Maximum number of items a stage of a Pipeline takes from its queue at once, processed as a single synchronized task.
+#if !defined(TASKSYNC_PIPELINE_BATCH)
+#   define TASKSYNC_PIPELINE_BATCH 64
+#endif
+
+// Duration in nanoseconds parallel_for() aims at for each chunk, which bounds how long joining waits for it.
+#if !defined(TASKSYNC_PARALLEL_FOR_CHUNK_NS)
+#   define TASKSYNC_PARALLEL_FOR_CHUNK_NS 100000
+#endif
+
+// Test hooks, used by the deterministic mode of tasksync-stress to control the interleaving of threads.
+// TASKSYNC_SCHEDULE_POINT( point ) is reached where the order of threads matters, outside of any lock;
+// TASKSYNC_SCHEDULE_WAIT( condition, lock, predicate ) is how joining waits for running tasks and
+// TASKSYNC_SCHEDULE_NOTIFY( condition ) how ending tasks wake it up.
+#if !defined(TASKSYNC_SCHEDULE_POINT)
+#   define TASKSYNC_SCHEDULE_POINT( point ) static_cast<void>( 0 )
+#endif
+
+#if !defined(TASKSYNC_SCHEDULE_WAIT)
+#   define TASKSYNC_SCHEDULE_WAIT( condition, lock, predicate ) ( condition ).wait( lock, predicate )
+#endif
+
+#if !defined(TASKSYNC_SCHEDULE_NOTIFY)
+#   define TASKSYNC_SCHEDULE_NOTIFY( condition ) ( condition ).notify_one()
+#endif
+
+// Internal: stop tokens, thus TaskSynchronizer::get_stop_token() and spawn_thread(), need the C++20 standard library.
+#if defined(__has_include)
+#   if __has_include(<version>)
+#       include <version>
+#   endif
+#endif
+#if defined(__cpp_lib_jthread)
+#   define TASKSYNC_DETAILS_STOP_TOKEN 1
+#else
+#   define TASKSYNC_DETAILS_STOP_TOKEN 0
+#endif
+
+// Internal: features which need synchronized tasks to remember where they come from.
+#define TASKSYNC_DETAILS_TASK_LABEL ( TASKSYNC_RUNNING_REGISTRY || TASKSYNC_TRACE )
+#define TASKSYNC_DETAILS_TASK_ORIGIN ( TASKSYNC_CALL_SITES || TASKSYNC_DETAILS_TASK_LABEL )
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <tasksync/config.hpp>
+#include <tasksync/stats.hpp>
+
+#if defined(_WIN32)
+#   error "TASKSYNC_CPU_TIME requires the CPU time clocks of threads of POSIX (CLOCK_THREAD_CPUTIME_ID)"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <time.h>
+
+namespace tasksync {
+
+    /** CPU time and wall time of the sampled synchronized task bodies of a TaskSynchronizer, telling tasks which
+        are compute bound from those which are blocked (on I/O, locks, or other tasks).
+        @see TaskSynchronizer::task_times()
+    */
+    struct TaskTimes
+    {
+        /// Number of task bodies sampled.
+        int64_t samples = 0;
+
+        /// Cumulative duration of the sampled bodies, on a monotonic clock.
+        std::chrono::nanoseconds wall_time{ 0 };
+
+        /// Cumulative CPU time consumed by the threads executing the sampled bodies, while executing them.
+        std::chrono::nanoseconds cpu_time{ 0 };
+
+        /** @return Fraction of their wall time the sampled bodies spent on a CPU: near 1 if they are compute bound,
+                    near 0 if they are mostly blocked or preempted; 0 without samples.
+        */
+        double cpu_ratio() const
+        {
+            return wall_time.count() > 0 ? static_cast<double>( cpu_time.count() ) / static_cast<double>( wall_time.count() ) : 0.0;
+        }
+    };
+
+    namespace details {
+
+        /** @return CPU time consumed by the calling thread so far. */
+        inline std::chrono::nanoseconds thread_cpu_time()
+        {
+            timespec time{};
+            ::clock_gettime( CLOCK_THREAD_CPUTIME_ID, &time );
+            return std::chrono::seconds{ time.tv_sec } + std::chrono::nanoseconds{ time.tv_nsec };
+        }
+
+        /** Samples the wall and CPU times of some of the task executions of a synchronizer, and sums them. */
+        class task_time_sampler
+        {
+        public:
+            using clock = std::chrono::steady_clock;
+
+            /// Beginning of a sampled execution, default for executions which are not sampled.
+            struct sample
+            {
+                clock::time_point wall_begin;
+                std::chrono::nanoseconds cpu_begin;
+            };
+
+            /** Set how many executions are counted for each one sampled, 0 disables sampling. */
+            void set_sampling_rate( uint32_t one_in ) { m_countdown.set_rate( one_in ); }
+            uint32_t sampling_rate() const { return m_countdown.rate(); }
+
+            sample sample_begin()
+            {
+                if( !m_countdown.sample() )
+                    return {};
+                return { clock::now(), thread_cpu_time() };
+            }
+
+            void sample_end( const sample& begin )
+            {
+                if( begin.wall_begin == clock::time_point{} )
+                    return;
+
+                const auto cpu_time = thread_cpu_time() - begin.cpu_begin;
+                const auto wall_time = clock::now() - begin.wall_begin;
+                m_samples.fetch_add( 1, std::memory_order_relaxed );
+                m_wall_ns.fetch_add( std::chrono::duration_cast<std::chrono::nanoseconds>( wall_time ).count(), std::memory_order_relaxed );
+                m_cpu_ns.fetch_add( cpu_time.count(), std::memory_order_relaxed );
+            }
+
+            /** @return The sums so far, each one read separately: a sample ending meanwhile may be partly counted. */
+            TaskTimes times() const
+            {
+                TaskTimes times;
+                times.samples = m_samples.load( std::memory_order_relaxed );
+                times.wall_time = std::chrono::nanoseconds{ m_wall_ns.load( std::memory_order_relaxed ) };
+                times.cpu_time = std::chrono::nanoseconds{ m_cpu_ns.load( std::memory_order_relaxed ) };
+                return times;
+            }
+
+        private:
+            sampling_countdown m_countdown{ TASKSYNC_CPU_TIME_SAMPLING_RATE };
+            std::atomic<int64_t> m_samples{ 0 };
+            std::atomic<int64_t> m_wall_ns{ 0 };
+            std::atomic<int64_t> m_cpu_ns{ 0 };
+        };
+
+    }
+}
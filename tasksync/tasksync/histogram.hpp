@@ -0,0 +1,192 @@
+#pragma once
+
+#include <tasksync/config.hpp>
+#include <tasksync/stats.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace tasksync {
+
+    namespace details { class concurrent_duration_histogram; }
+
+    /** Distribution of durations, in logarithmic buckets.
+
+        Like HDR histograms, each power of two range of durations is split in a fixed number of linear
+        sub-buckets, which keeps the relative error of the reported values under 1/8 whatever the magnitude.
+        Durations from 1ns to ~4.9 hours are distinguished, longer ones are counted in the last bucket.
+        The maximum is tracked exactly.
+
+        Histograms of several synchronizers can be combined with merge().
+        @see TaskSynchronizer::task_durations()
+    */
+    class DurationHistogram
+    {
+    public:
+        static constexpr int sub_bucket_bits = 3;
+        static constexpr int max_magnitude = 43;
+        static constexpr int64_t sub_bucket_count = int64_t{ 1 } << sub_bucket_bits;
+        static constexpr std::size_t bucket_count = sub_bucket_count + ( max_magnitude - sub_bucket_bits + 1 ) * sub_bucket_count;
+
+        /** @return Index of the bucket counting the provided duration, in nanoseconds. */
+        static constexpr std::size_t bucket_index( int64_t duration_ns )
+        {
+            if( duration_ns < sub_bucket_count )
+                return duration_ns < 0 ? 0 : static_cast<std::size_t>( duration_ns );
+
+            int magnitude = 0;
+            for( auto value = duration_ns; value > 1; value >>= 1 )
+                ++magnitude;
+
+            if( magnitude > max_magnitude )
+                return bucket_count - 1;
+
+            const int shift = magnitude - sub_bucket_bits;
+            const auto sub_bucket = ( duration_ns >> shift ) - sub_bucket_count;
+            return static_cast<std::size_t>( sub_bucket_count * ( shift + 1 ) + sub_bucket );
+        }
+
+        /** @return Highest duration in nanoseconds counted by the provided bucket. */
+        static constexpr int64_t bucket_upper_bound( std::size_t index )
+        {
+            const auto bucket = static_cast<int64_t>( index );
+            if( bucket < sub_bucket_count )
+                return bucket;
+
+            const auto shift = bucket / sub_bucket_count - 1;
+            const auto sub_bucket = bucket % sub_bucket_count;
+            return ( ( sub_bucket_count + sub_bucket + 1 ) << shift ) - 1;
+        }
+
+        void record( std::chrono::nanoseconds duration )
+        {
+            const auto duration_ns = duration.count();
+            ++m_counts[ bucket_index( duration_ns ) ];
+            ++m_count;
+            if( duration_ns > m_max_ns )
+                m_max_ns = duration_ns;
+        }
+
+        /** Add all the durations recorded by another histogram to this one. */
+        void merge( const DurationHistogram& other )
+        {
+            for( std::size_t index = 0; index < bucket_count; ++index )
+                m_counts[ index ] += other.m_counts[ index ];
+            m_count += other.m_count;
+            if( other.m_max_ns > m_max_ns )
+                m_max_ns = other.m_max_ns;
+        }
+
+        /** @return Number of recorded durations. */
+        int64_t count() const { return m_count; }
+
+        /** @return Longest recorded duration, zero if none was recorded. */
+        std::chrono::nanoseconds max() const { return std::chrono::nanoseconds{ m_max_ns }; }
+
+        /** @return Duration that `ratio` (between 0 and 1) of the recorded durations do not exceed,
+                    zero if none was recorded.
+        */
+        std::chrono::nanoseconds percentile( double ratio ) const
+        {
+            if( m_count == 0 )
+                return std::chrono::nanoseconds{ 0 };
+
+            auto rank = static_cast<int64_t>( ratio * static_cast<double>( m_count ) + 0.5 );
+            if( rank < 1 )
+                rank = 1;
+
+            int64_t counted = 0;
+            for( std::size_t index = 0; index < bucket_count; ++index )
+            {
+                counted += m_counts[ index ];
+                if( counted >= rank )
+                {
+                    const auto upper_bound = bucket_upper_bound( index );
+                    return std::chrono::nanoseconds{ upper_bound < m_max_ns ? upper_bound : m_max_ns };
+                }
+            }
+            return max();
+        }
+
+        std::chrono::nanoseconds p50() const { return percentile( 0.50 ); }
+        std::chrono::nanoseconds p99() const { return percentile( 0.99 ); }
+
+    private:
+        friend class details::concurrent_duration_histogram;
+
+        std::array<int64_t, bucket_count> m_counts{};
+        int64_t m_count = 0;
+        int64_t m_max_ns = 0;
+    };
+
+    namespace details {
+
+        /** DurationHistogram which can be recorded into from any number of threads. */
+        class concurrent_duration_histogram
+        {
+        public:
+
+            void record( std::chrono::nanoseconds duration )
+            {
+                const auto duration_ns = duration.count();
+                m_counts[ DurationHistogram::bucket_index( duration_ns ) ].fetch_add( 1, std::memory_order_relaxed );
+
+                auto max_ns = m_max_ns.load( std::memory_order_relaxed );
+                while( duration_ns > max_ns
+                    && !m_max_ns.compare_exchange_weak( max_ns, duration_ns, std::memory_order_relaxed ) )
+                {}
+            }
+
+            DurationHistogram snapshot() const
+            {
+                DurationHistogram histogram;
+                for( std::size_t index = 0; index < DurationHistogram::bucket_count; ++index )
+                {
+                    const auto count = m_counts[ index ].load( std::memory_order_relaxed );
+                    histogram.m_counts[ index ] = count;
+                    histogram.m_count += count;
+                }
+                histogram.m_max_ns = m_max_ns.load( std::memory_order_relaxed );
+                return histogram;
+            }
+
+        private:
+            std::array<std::atomic<int64_t>, DurationHistogram::bucket_count> m_counts{};
+            std::atomic<int64_t> m_max_ns{ 0 };
+        };
+
+        /** Records the durations of a sample of the synchronized tasks executions.
+
+            Only one execution out of `sampling_rate()` (counted per shard of threads) reads the clock,
+            the others only increment the counter of their shard.
+        */
+        class task_duration_sampler
+        {
+        public:
+            using clock = std::chrono::steady_clock;
+
+            /** Set how many executions are counted for each one sampled, 0 disables sampling. */
+            void set_sampling_rate( uint32_t one_in ) { m_countdown.set_rate( one_in ); }
+            uint32_t sampling_rate() const { return m_countdown.rate(); }
+
+            /** @return The beginning of the execution if it is sampled, a default time point otherwise. */
+            clock::time_point sample_begin() { return m_countdown.sample() ? clock::now() : clock::time_point{}; }
+
+            void sample_end( clock::time_point begin )
+            {
+                if( begin != clock::time_point{} )
+                    m_durations.record( clock::now() - begin );
+            }
+
+            DurationHistogram durations() const { return m_durations.snapshot(); }
+
+        private:
+            sampling_countdown m_countdown{ TASKSYNC_HISTOGRAMS_SAMPLING_RATE };
+            concurrent_duration_histogram m_durations;
+        };
+
+    }
+}
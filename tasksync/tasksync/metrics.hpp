@@ -0,0 +1,140 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+
+#if !TASKSYNC_REGISTRY
+#   error "tasksync/metrics.hpp requires TASKSYNC_REGISTRY to be enabled (config.tasksync.registry)"
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tasksync {
+
+    namespace details {
+
+        struct synchronizer_metrics
+        {
+            const void* synchronizer;
+            const char* name;
+            int64_t running_tasks;
+            JoinState join_state;
+            SynchronizerStats stats;
+        };
+
+        inline void write_metric_labels( std::ostream& out, const synchronizer_metrics& metrics )
+        {
+            out << "{synchronizer=\"" << metrics.synchronizer << '"';
+            if( metrics.name )
+            {
+                out << ",name=\"";
+                for( auto* character = metrics.name; *character; ++character )
+                {
+                    switch( *character )
+                    {
+                    case '\\': out << "\\\\"; break;
+                    case '"':  out << "\\\""; break;
+                    case '\n': out << "\\n"; break;
+                    default:   out << *character;
+                    }
+                }
+                out << '"';
+            }
+            out << '}';
+        }
+
+        template< class Value >
+        void write_metric_family( std::ostream& out, const std::vector<synchronizer_metrics>& all_metrics,
+                                  const char* family, const char* type, const char* help, Value&& value )
+        {
+            out << "# HELP " << family << ' ' << help << '\n'
+                << "# TYPE " << family << ' ' << type << '\n';
+            for( const auto& metrics : all_metrics )
+            {
+                out << family;
+                write_metric_labels( out, metrics );
+                out << ' ' << value( metrics ) << '\n';
+            }
+        }
+    }
+
+    /** Write the metrics of all the existing synchronizers in the Prometheus text exposition format.
+
+        Synchronizers are read one registry shard at a time, which only blocks their construction and destruction,
+        never the execution of their tasks.
+        Only available if `TASKSYNC_REGISTRY` is enabled (`config.tasksync.registry`).
+        @see TaskSynchronizer::set_metrics_name()
+    */
+    inline void write_metrics( std::ostream& out )
+    {
+        std::vector<details::synchronizer_metrics> all_metrics;
+        details::synchronizer_registry::instance().visit( [&]( const details::registered_synchronizer& entry ) {
+            const auto& synchronizer = entry.synchronizer();
+            all_metrics.push_back( { &synchronizer, entry.name(), synchronizer.running_tasks(), entry.join_state(), synchronizer.stats() } );
+        } );
+
+        using metrics = details::synchronizer_metrics;
+
+        out << "# HELP tasksync_synchronizers Number of existing task synchronizers.\n"
+            << "# TYPE tasksync_synchronizers gauge\n"
+            << "tasksync_synchronizers " << all_metrics.size() << '\n';
+
+        details::write_metric_family( out, all_metrics, "tasksync_running_tasks", "gauge",
+            "Number of synchronized tasks being executed.",
+            []( const metrics& m ) { return m.running_tasks; } );
+        details::write_metric_family( out, all_metrics, "tasksync_peak_running_tasks", "gauge",
+            "Highest number of synchronized tasks executed at the same time.",
+            []( const metrics& m ) { return m.stats.peak_running_tasks; } );
+        details::write_metric_family( out, all_metrics, "tasksync_executed_tasks_total", "counter",
+            "Number of synchronized task bodies executed.",
+            []( const metrics& m ) { return m.stats.executed_tasks; } );
+        details::write_metric_family( out, all_metrics, "tasksync_skipped_tasks_total", "counter",
+            "Number of synchronized tasks invoked during a join, which were not executed.",
+            []( const metrics& m ) { return m.stats.skipped_tasks; } );
+        details::write_metric_family( out, all_metrics, "tasksync_join_state", "gauge",
+            "Joining progress: 0 not joined, 1 joining, 2 joined.",
+            []( const metrics& m ) { return static_cast<int>( m.join_state ); } );
+        details::write_metric_family( out, all_metrics, "tasksync_joins_total", "counter",
+            "Number of joins performed.",
+            []( const metrics& m ) { return m.stats.joins; } );
+        details::write_metric_family( out, all_metrics, "tasksync_join_wait_seconds_total", "counter",
+            "Cumulative time spent by joins waiting for running tasks to end.",
+            []( const metrics& m ) { return std::chrono::duration<double>( m.stats.join_wait_time ).count(); } );
+    }
+
+    /** @return The metrics of all the existing synchronizers in the Prometheus text exposition format. @see write_metrics() */
+    inline std::string render_metrics()
+    {
+        std::ostringstream out;
+        write_metrics( out );
+        return out.str();
+    }
+
+    /** Write the metrics of all the existing synchronizers in the Prometheus text exposition format into a file.
+
+        The metrics are written to a temporary file next to `path` which then replaces it,
+        so that readers never see a partially written file.
+        @return true on success, false if the file could not be written.
+        @see write_metrics()
+    */
+    inline bool write_metrics_file( const std::string& path )
+    {
+        const auto temporary_path = path + ".tmp";
+        {
+            std::ofstream file{ temporary_path, std::ios::trunc };
+            if( !file )
+                return false;
+            write_metrics( file );
+            file.flush();
+            if( !file )
+                return false;
+        }
+        return std::rename( temporary_path.c_str(), path.c_str() ) == 0;
+    }
+
+}
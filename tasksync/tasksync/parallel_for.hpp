@@ -0,0 +1,211 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+#include <tasksync/task_group.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <thread>
+#include <utility>
+
+namespace tasksync {
+
+    namespace details {
+
+        /** Picks the size of the next chunk of a worker of parallel_for(), from the measured duration of its previous ones. */
+        class chunk_sizer
+        {
+        public:
+            explicit chunk_sizer( int64_t workers ) : m_workers( workers ) {}
+
+            /** @return Number of items of the next chunk, out of the `remaining` ones. */
+            int64_t next_size( int64_t remaining ) const
+            {
+                // Never more than a share of what remains, so that the last chunks are balanced between workers.
+                const auto share = std::max<int64_t>( 1, remaining / ( 2 * m_workers ) );
+                if( m_ns_per_item <= 0.0 )
+                    return 1; // Measure one item first.
+                const auto sized = static_cast<int64_t>( static_cast<double>( TASKSYNC_PARALLEL_FOR_CHUNK_NS ) / m_ns_per_item );
+                return std::clamp<int64_t>( sized, 1, share );
+            }
+
+            void measure( int64_t items, std::chrono::nanoseconds duration )
+            {
+                const auto ns_per_item = std::max( 1.0, static_cast<double>( duration.count() ) / static_cast<double>( items ) );
+                m_ns_per_item = m_ns_per_item <= 0.0 ? ns_per_item : ( m_ns_per_item + ns_per_item ) / 2;
+            }
+
+        private:
+            const int64_t m_workers;
+            double m_ns_per_item = 0.0;
+        };
+
+        /** State shared by the caller of parallel_for() and the helpers it submits, which may start after it returned. */
+        template< class Index, class SynchedChunk >
+        class parallel_for_state
+        {
+        public:
+            parallel_for_state( Index first, Index last, int64_t workers, SynchedChunk synched_chunk )
+                : m_next( first ), m_last( last ), m_workers( workers ), m_synched_chunk( std::move( synched_chunk ) )
+            {}
+
+            /** Claim and execute chunks until none remains, the synchronizer is joined or a chunk throws. */
+            void run_chunks()
+            {
+                auto synched_chunk = m_synched_chunk; // Copied: invoked concurrently by workers.
+                chunk_sizer sizer{ m_workers };
+                Index begin;
+                Index end;
+                while( claim( sizer, begin, end ) )
+                {
+                    bool executed = false;
+                    const auto chunk_begin = std::chrono::steady_clock::now();
+                    try
+                    {
+                        synched_chunk( begin, end, executed );
+                    }
+                    catch( ... )
+                    {
+                        capture( std::current_exception() );
+                        close();
+                        return;
+                    }
+                    if( !executed ) // Joined: no chunk must start anymore.
+                    {
+                        m_stopped = true;
+                        close();
+                        return;
+                    }
+                    sizer.measure( static_cast<int64_t>( end - begin ), std::chrono::steady_clock::now() - chunk_begin );
+                }
+            }
+
+            /** Run chunks unless the caller is done already. */
+            void help()
+            {
+                m_helping.add();
+                std::atomic_thread_fence( std::memory_order_seq_cst ); // Pairs with finish().
+                if( !m_closed.load( std::memory_order_relaxed ) )
+                    run_chunks();
+                m_helping.end();
+            }
+
+            /** Prevent helpers from starting, wait for the started ones, then rethrow the first exception of a chunk.
+                @return true if all the items were processed, false if stopped by a join.
+            */
+            bool finish()
+            {
+                close();
+                std::atomic_thread_fence( std::memory_order_seq_cst ); // Pairs with help().
+                m_helping.wait();
+                if( m_exception )
+                    std::rethrow_exception( m_exception );
+                return !m_stopped;
+            }
+
+        private:
+            std::atomic<Index> m_next;
+            const Index m_last;
+            const int64_t m_workers;
+            const SynchedChunk m_synched_chunk;
+            std::atomic<bool> m_closed{ false };
+            std::atomic<bool> m_stopped{ false };
+            pending_counter m_helping;
+            std::mutex m_exception_mutex;
+            std::exception_ptr m_exception; ///< Protected by m_exception_mutex, read once helpers ended.
+
+            bool claim( const chunk_sizer& sizer, Index& begin, Index& end )
+            {
+                begin = m_next.load( std::memory_order_relaxed );
+                while( begin < m_last && !m_closed.load( std::memory_order_relaxed ) )
+                {
+                    const auto size = sizer.next_size( static_cast<int64_t>( m_last - begin ) );
+                    end = static_cast<Index>( begin + static_cast<Index>( size ) );
+                    if( m_next.compare_exchange_weak( begin, end, std::memory_order_relaxed ) )
+                        return true;
+                }
+                return false;
+            }
+
+            void close()
+            {
+                m_closed.store( true, std::memory_order_relaxed );
+            }
+
+            void capture( std::exception_ptr exception )
+            {
+                std::scoped_lock lock{ m_exception_mutex };
+                if( !m_exception )
+                    m_exception = std::move( exception );
+            }
+        };
+
+    }
+
+    /** Call `body( index )` for each index in [first, last), in parallel, in chunks synchronized with `task_sync`.
+
+        The items are split in chunks which are each executed as a synchronized task: once a joining function
+        of the synchronizer is called, no new chunk starts and the join only waits for the chunks being executed.
+        Chunk sizes adapt to the measured duration of the body, aiming at `TASKSYNC_PARALLEL_FOR_CHUNK_NS` per
+        chunk, and shrink as the remaining items get fewer to balance the end of the loop between workers.
+
+        The calling thread executes chunks too, helped by up to `concurrency - 1` helpers submitted to the executor
+        (any callable taking a callable with no arguments, see TaskGroup). Helpers which start after all the items
+        were claimed return right away: the call never waits for helpers which did not start, so the executor can
+        be the one running the caller.
+
+        @param concurrency Maximum number of threads executing chunks, the hardware concurrency if zero.
+        @return true if every item was processed, false if a join stopped the loop.
+        Rethrows the first exception thrown by the body, once no chunk is executing; no new chunk starts after it.
+    */
+    template< std::integral Index, class Executor, class Body >
+    bool parallel_for( TaskSynchronizer& task_sync, Executor&& executor, Index first, Index last, Body&& body,
+                       std::size_t concurrency = 0 )
+    {
+        if( !( first < last ) )
+            return true;
+
+        if( concurrency == 0 )
+            concurrency = std::max( 1u, std::thread::hardware_concurrency() );
+        const auto items = static_cast<uint64_t>( last - first );
+        const auto workers = static_cast<int64_t>( std::min<uint64_t>( concurrency, items ) );
+
+        auto synched_chunk = task_sync.synchronized( [ &body ]( Index begin, Index end, bool& executed ) {
+            executed = true;
+            for( auto index = begin; index < end; ++index )
+                body( index );
+        } );
+        using State = details::parallel_for_state<Index, decltype( synched_chunk )>;
+        const auto state = std::make_shared<State>( first, last, workers, std::move( synched_chunk ) );
+
+        for( int64_t helper = 1; helper < workers; ++helper )
+            executor( [ state ]{ state->help(); } );
+
+        state->run_chunks();
+        return state->finish();
+    }
+
+    /** Call `body( element )` for each element of a random access range, in parallel, in chunks synchronized with `task_sync`.
+        @see parallel_for( TaskSynchronizer&, Executor&&, Index, Index, Body&&, std::size_t )
+    */
+    template< std::ranges::random_access_range Range, class Executor, class Body >
+        requires std::ranges::sized_range<Range>
+    bool parallel_for( TaskSynchronizer& task_sync, Executor&& executor, Range&& range, Body&& body,
+                       std::size_t concurrency = 0 )
+    {
+        const auto begin = std::ranges::begin( range );
+        return parallel_for( task_sync, std::forward<Executor>( executor ),
+                             std::ranges::range_difference_t<Range>{ 0 }, std::ranges::ssize( range ),
+                             [ &body, begin ]( auto index ) { body( begin[ index ] ); },
+                             concurrency );
+    }
+
+}
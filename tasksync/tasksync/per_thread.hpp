@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace tasksync::details {
+
+    /** Process-wide list of data blocks owned each by one thread and readable from any thread without locking.
+
+        A block is allocated the first time a thread asks for its own, then linked in a list which never shrinks:
+        readers can be visiting it at any time, so blocks are intentionally never deleted. Once its thread ends,
+        a block is recycled for the next thread asking for one.
+
+        `Block` must be default constructible and provide `attach_to_this_thread()`, called when a thread
+        begins to use it.
+    */
+    template< class Block >
+    class per_thread_registry
+    {
+    public:
+
+        static per_thread_registry& instance()
+        {
+            static per_thread_registry registry;
+            return registry;
+        }
+
+        /** @return The block of the calling thread. */
+        Block& local()
+        {
+            thread_local const ThreadNode thread_node{ *this };
+            return thread_node.node.block;
+        }
+
+        /** Call `visitor` with each block currently used by a thread. */
+        template< class Visitor >
+        void visit_in_use( Visitor&& visitor ) const
+        {
+            for( auto* node = m_head.load( std::memory_order_acquire ); node; node = node->next )
+            {
+                if( node->in_use.load( std::memory_order_acquire ) )
+                    visitor( std::as_const( node->block ) );
+            }
+        }
+
+        /** Call `visitor` with each block, including the ones of ended threads which were not recycled yet. */
+        template< class Visitor >
+        void visit_all( Visitor&& visitor ) const
+        {
+            for( auto* node = m_head.load( std::memory_order_acquire ); node; node = node->next )
+                visitor( std::as_const( node->block ) );
+        }
+
+    private:
+
+        struct Node
+        {
+            Block block;
+            std::atomic<bool> in_use{ true };
+            Node* next = nullptr;
+        };
+
+        std::atomic<Node*> m_head{ nullptr };
+
+        per_thread_registry() = default;
+
+        Node& acquire()
+        {
+            for( auto* node = m_head.load( std::memory_order_acquire ); node; node = node->next )
+            {
+                bool in_use = false;
+                if( node->in_use.compare_exchange_strong( in_use, true, std::memory_order_acquire ) )
+                {
+                    node->block.attach_to_this_thread();
+                    return *node;
+                }
+            }
+
+            auto* node = new Node;
+            node->block.attach_to_this_thread();
+            node->next = m_head.load( std::memory_order_relaxed );
+            while( !m_head.compare_exchange_weak( node->next, node, std::memory_order_release, std::memory_order_relaxed ) )
+            {}
+            return *node;
+        }
+
+        struct ThreadNode
+        {
+            Node& node;
+
+            explicit ThreadNode( per_thread_registry& registry ) : node( registry.acquire() ) {}
+            ~ThreadNode() { node.in_use.store( false, std::memory_order_release ); }
+        };
+    };
+
+}
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <span>
+#include <stop_token>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tasksync {
+
+    namespace details {
+
+        /** Bounded queue between two threads, a producer and a consumer, both blocking: the producer while it is
+            full, the consumer while it is empty. Items are moved in and out by batches, publishing each batch
+            with a single atomic operation.
+
+            Each index counts items by steps of 2, its lowest bit being set once the queue is closed, so that
+            closing wakes up both sides.
+        */
+        template< class T >
+        class bounded_queue
+        {
+        public:
+            static constexpr std::size_t max_capacity = std::size_t{ 1 } << 30;
+
+            /** @param capacity Maximum number of items queued, rounded up to a power of 2. */
+            explicit bounded_queue( std::size_t capacity )
+                : m_mask( static_cast<uint32_t>( std::bit_ceil( std::clamp<std::size_t>( capacity, 1, max_capacity ) ) - 1 ) )
+                , m_slots( std::make_unique<slot[]>( std::size_t{ m_mask } + 1 ) )
+            {}
+
+            ~bounded_queue()
+            {
+                const auto tail = m_tail.load( std::memory_order_acquire ) & ~closed;
+                for( auto index = m_head.load( std::memory_order_acquire ) & ~closed; index != tail; index += step )
+                    std::destroy_at( at( index ) );
+            }
+
+            bounded_queue( const bounded_queue& ) = delete;
+            bounded_queue& operator=( const bounded_queue& ) = delete;
+
+            std::size_t capacity() const { return std::size_t{ m_mask } + 1; }
+
+            /** Move items into the queue, blocking until there is room for at least one of them.
+                Producer side only.
+                @return Number of items moved from the front of `items`, 0 only if the queue is closed.
+            */
+            std::size_t push( T* items, std::size_t count )
+            {
+                const auto tail = m_tail.load( std::memory_order_relaxed );
+                auto head = m_head.load( std::memory_order_acquire );
+                while( true )
+                {
+                    if( ( tail | head ) & closed )
+                        return 0;
+                    const auto room = capacity() - distance( head, tail );
+                    if( room != 0 )
+                    {
+                        const auto pushed = std::min( room, count );
+                        for( std::size_t offset = 0; offset < pushed; ++offset )
+                            ::new( static_cast<void*>( at( tail + static_cast<uint32_t>( offset ) * step ) ) ) T( std::move( items[ offset ] ) );
+                        m_tail.fetch_add( static_cast<uint32_t>( pushed ) * step, std::memory_order_release );
+                        m_tail.notify_one();
+                        return pushed;
+                    }
+                    m_head.wait( head, std::memory_order_acquire );
+                    head = m_head.load( std::memory_order_acquire );
+                }
+            }
+
+            /** Move up to `max` items out of the queue to the back of `batch`, blocking while it is empty and open.
+                Consumer side only. Items pushed before closing are still popped.
+                @return false if the queue is closed and empty.
+            */
+            bool pop( std::vector<T>& batch, std::size_t max )
+            {
+                const auto head = m_head.load( std::memory_order_relaxed );
+                auto tail = m_tail.load( std::memory_order_acquire );
+                while( true )
+                {
+                    const auto available = distance( head, tail );
+                    if( available != 0 )
+                    {
+                        const auto popped = std::min( available, max );
+                        for( std::size_t offset = 0; offset < popped; ++offset )
+                        {
+                            auto* item = at( head + static_cast<uint32_t>( offset ) * step );
+                            batch.push_back( std::move( *item ) );
+                            std::destroy_at( item );
+                        }
+                        m_head.fetch_add( static_cast<uint32_t>( popped ) * step, std::memory_order_release );
+                        m_head.notify_one();
+                        return true;
+                    }
+                    if( tail & closed )
+                        return false;
+                    m_tail.wait( tail, std::memory_order_acquire );
+                    tail = m_tail.load( std::memory_order_acquire );
+                }
+            }
+
+            /** Prevent items from being pushed anymore, and wake up both sides. Can be called from any thread. */
+            void close()
+            {
+                m_tail.fetch_or( closed, std::memory_order_acq_rel );
+                m_head.fetch_or( closed, std::memory_order_acq_rel );
+                m_tail.notify_all();
+                m_head.notify_all();
+            }
+
+        private:
+            struct slot
+            {
+                alignas( T ) std::byte storage[ sizeof( T ) ];
+            };
+
+            static constexpr uint32_t closed = 1;
+            static constexpr uint32_t step = 2;
+
+            const uint32_t m_mask;
+            const std::unique_ptr<slot[]> m_slots;
+            alignas( 64 ) std::atomic<uint32_t> m_head{ 0 }; ///< Next item to pop, modified by the consumer.
+            alignas( 64 ) std::atomic<uint32_t> m_tail{ 0 }; ///< Next item to push, modified by the producer.
+
+            T* at( uint32_t index ) const
+            {
+                return std::launder( reinterpret_cast<T*>( m_slots[ ( index / step ) & m_mask ].storage ) );
+            }
+
+            static std::size_t distance( uint32_t head, uint32_t tail ) { return ( ( tail & ~closed ) - ( head & ~closed ) ) / step; }
+        };
+
+        /// Output of the last stage, of which the results are ignored.
+        struct pipeline_sink {};
+
+        /** Stage of a Pipeline: its input queue, and a thread owned by its synchronizer processing the items of the
+            queue by batches, as synchronized tasks, handing their results to the next stage.
+        */
+        template< class Input, class Stage >
+        class pipeline_stage
+        {
+        public:
+            using output_type = std::remove_cvref_t<std::invoke_result_t<Stage&, Input&&>>;
+
+            pipeline_stage( std::size_t capacity, Stage stage )
+                : m_input( capacity )
+                , m_stage( std::move( stage ) )
+            {}
+
+            bounded_queue<Input>& input() { return m_input; }
+            TaskSynchronizer& task_sync() { return m_task_sync; }
+
+            /** Start the thread of this stage, handing the results to `output`, null for the last stage. */
+            template< class Output >
+            void start( bounded_queue<Output>* output )
+            {
+                m_task_sync.spawn_thread( [ this, output ]( std::stop_token stop_token ) {
+                    // Joining closes the queues, waking up the thread if it waits for items, or for room downstream.
+                    std::stop_callback close_on_join{ stop_token, [ this, output ] {
+                        m_input.close();
+                        if( output )
+                            output->close();
+                    } };
+                    run( stop_token, output );
+                } );
+            }
+
+            /** Block until the thread of this stage ended, once its input was closed and processed, or once joined. */
+            void wait_ended() const
+            {
+                while( !m_ended.load( std::memory_order_acquire ) )
+                    m_ended.wait( false, std::memory_order_acquire );
+            }
+
+        private:
+            bounded_queue<Input> m_input;
+            Stage m_stage;
+            std::atomic<bool> m_ended{ false };
+            TaskSynchronizer m_task_sync; // Last: destroyed first, joining the thread using the other members.
+
+            template< class Output >
+            void run( const std::stop_token& stop_token, bounded_queue<Output>* output )
+            {
+                constexpr bool is_last = std::is_same_v<Output, pipeline_sink>;
+                std::vector<Output> outputs;
+                auto process = m_task_sync.synchronized( [ & ]( std::vector<Input>& batch ) {
+                    for( auto& item : batch )
+                    {
+                        if constexpr( is_last )
+                            std::invoke( m_stage, std::move( item ) );
+                        else
+                            outputs.push_back( std::invoke( m_stage, std::move( item ) ) );
+                    }
+                    for( std::size_t pushed = 0; pushed < outputs.size(); )
+                    {
+                        const auto count = output->push( outputs.data() + pushed, outputs.size() - pushed );
+                        if( count == 0 ) // Closed by a join: the results not handed over are dropped.
+                            break;
+                        pushed += count;
+                    }
+                    outputs.clear();
+                } );
+
+                std::vector<Input> batch;
+                batch.reserve( std::min( m_input.capacity(), std::size_t{ TASKSYNC_PIPELINE_BATCH } ) );
+                while( !stop_token.stop_requested() && m_input.pop( batch, batch.capacity() ) )
+                {
+                    process( batch );
+                    batch.clear();
+                }
+
+                if constexpr( !is_last ) // The next stage ends once it processed what was handed to it.
+                    output->close();
+                m_ended.store( true, std::memory_order_release );
+                m_ended.notify_all();
+            }
+        };
+
+        /// The stages of a pipeline, each one taking the output of the previous one.
+        template< class Input, class... Stages >
+        struct pipeline_stages { using type = std::tuple<>; };
+
+        template< class Input, class Stage, class... Stages >
+        struct pipeline_stages<Input, Stage, Stages...>
+        {
+            using output_type = typename pipeline_stage<Input, Stage>::output_type;
+            static_assert( sizeof...( Stages ) == 0 || !std::is_void_v<output_type>, "only the last stage of a pipeline can return void" );
+
+            using type = decltype( std::tuple_cat( std::declval<std::tuple<std::unique_ptr<pipeline_stage<Input, Stage>>>>(),
+                                                   std::declval<typename pipeline_stages<output_type, Stages...>::type>() ) );
+        };
+
+    }
+
+    /** Stages executed each by its own thread, each one processing the items produced by the previous one: the
+        first stage takes the items pushed to the pipeline, each next stage the values returned by the previous one;
+        the values returned by the last stage are ignored. Obtained from pipeline().
+
+        Stages are connected by bounded queues, of the capacity given to pipeline(): pushing to a full queue blocks
+        until the next stage made room, so that the items in flight, hence the memory, stay bounded however fast
+        the items are pushed. A stage pops up to `TASKSYNC_PIPELINE_BATCH` items at once from its queue, processes
+        them as a single synchronized task, then hands all the results over at once: queues take one atomic
+        operation per batch on each side, and the threads only wake each other up when waiting.
+
+        Each stage owns a TaskSynchronizer, which also owns its thread: tasks or callbacks synchronized with it
+        (see synchronizer()) are joined along with the stage. Joining the pipeline joins the stages from upstream to
+        downstream: a stage is joined only after the previous one, so that no stage receives items after it was
+        joined.
+
+        Items are pushed from a single thread at a time. Stages must not throw: as for any thread, an exception
+        escaping a stage terminates the program.
+    */
+    template< class Input, class... Stages >
+    class Pipeline
+    {
+        static_assert( sizeof...( Stages ) > 0, "a pipeline needs at least one stage" );
+
+    public:
+        /** Start the threads of the stages. @see pipeline() */
+        Pipeline( std::size_t capacity, Stages... stages )
+            : Pipeline( capacity, std::index_sequence_for<Stages...>{}, std::move( stages )... )
+        {}
+
+        /** Destructor, joining the stages. Items still queued are destroyed without being processed. */
+        ~Pipeline() { join(); }
+
+        Pipeline( const Pipeline& ) = delete;
+        Pipeline& operator=( const Pipeline& ) = delete;
+
+        /** Hand an item to the first stage, blocking while its queue is full.
+            @return false if the item was not queued, because the pipeline was closed or joined.
+        */
+        bool push( Input item ) { return input().push( &item, 1 ) == 1; }
+
+        /** Hand items to the first stage, moved from `items`, blocking while its queue is full.
+            @return Number of items queued, from the front of `items`: all of them unless the pipeline was closed or
+                    joined meanwhile.
+        */
+        std::size_t push( std::span<Input> items )
+        {
+            std::size_t pushed = 0;
+            while( pushed < items.size() )
+            {
+                const auto count = input().push( items.data() + pushed, items.size() - pushed );
+                if( count == 0 )
+                    break;
+                pushed += count;
+            }
+            return pushed;
+        }
+
+        /** End the input: no item can be pushed anymore, and each stage ends once it processed the items handed to it. */
+        void close() { input().close(); }
+
+        /** Close the input, then block until all the items pushed went through all the stages, and join the stages. */
+        void finish()
+        {
+            close();
+            std::apply( []( auto&... stages ) { ( stages->wait_ended(), ... ); }, m_stages );
+            join();
+        }
+
+        /** Join the stages, from upstream to downstream: each stage stops at its next batch, dropping the items not
+            processed yet, and its running batch is waited for. Items cannot be pushed anymore.
+        */
+        void join()
+        {
+            std::apply( []( auto&... stages ) { ( stages->task_sync().join_tasks(), ... ); }, m_stages );
+        }
+
+        /** @return The synchronizer of the stage `Index`, to synchronize other tasks with the lifetime of the stage. */
+        template< std::size_t Index >
+        TaskSynchronizer& synchronizer() { return std::get<Index>( m_stages )->task_sync(); }
+
+        /** @return Maximum number of items queued before each stage. */
+        std::size_t capacity() const { return std::get<0>( m_stages )->input().capacity(); }
+
+        /** @return Number of stages of this pipeline. */
+        static constexpr std::size_t size() { return sizeof...( Stages ); }
+
+    private:
+        typename details::pipeline_stages<Input, Stages...>::type m_stages;
+
+        template< std::size_t... Indexes >
+        Pipeline( std::size_t capacity, std::index_sequence<Indexes...>, Stages... stages )
+            : m_stages{ std::make_unique<typename std::tuple_element_t<Indexes, decltype( m_stages )>::element_type>(
+                capacity, std::move( stages ) )... }
+        {
+            ( start<Indexes>(), ... );
+        }
+
+        template< std::size_t Index >
+        void start()
+        {
+            if constexpr( Index + 1 < sizeof...( Stages ) )
+                std::get<Index>( m_stages )->start( &std::get<Index + 1>( m_stages )->input() );
+            else
+                std::get<Index>( m_stages )->start( static_cast<details::bounded_queue<details::pipeline_sink>*>( nullptr ) );
+        }
+
+        auto& input() { return std::get<0>( m_stages )->input(); }
+    };
+
+    /** Start a pipeline of stages, each one executed by its own thread with the values returned by the previous one.
+        @param capacity Maximum number of items queued before each stage, rounded up to a power of 2.
+        @param stages Callables, the first one taking an `Input`, each next one the value returned by the previous one.
+        @see Pipeline
+    */
+    template< class Input, class... Stages >
+    Pipeline<Input, std::decay_t<Stages>...> pipeline( std::size_t capacity, Stages&&... stages )
+    {
+        return Pipeline<Input, std::decay_t<Stages>...>( capacity, std::forward<Stages>( stages )... );
+    }
+
+}
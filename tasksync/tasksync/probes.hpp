@@ -0,0 +1,37 @@
+#pragma once
+
+#include <tasksync/config.hpp>
+
+// Static tracing probes (USDT), for tracers like `perf`, bpftrace or SystemTap.
+//
+// Only available if `TASKSYNC_SDT` is enabled (`config.tasksync.sdt`) and `<sys/sdt.h>` is found
+// (systemtap-sdt-dev or equivalent), otherwise the probes are compiled out.
+// A probe is a single `nop` instruction until a tracer attaches to it.
+//
+// All the probes are in the `tasksync` provider and have two arguments:
+// the address of the TaskSynchronizer and its number of running tasks.
+//
+//   task_begin    A synchronized task body begins, after being counted as running.
+//   task_end      A synchronized task body ended, after being counted as not running anymore.
+//   task_skip     A synchronized task was invoked after its synchronizer was joined:
+//                 the number of running tasks is -1 if the synchronizer was already destroyed,
+//                 its address then being null for member functions synchronized with synchronized<&T::f>().
+//   join_request  A join begins, new tasks will not execute anymore.
+//   join_drain    A join ended, all the running tasks ended.
+//   reset         The synchronizer was joined and made reusable by reset().
+//
+// For example, to count the tasks executed by each synchronizer:
+//
+//   bpftrace -e 'usdt:./my_program:tasksync:task_begin { @tasks[arg0] = count(); }'
+
+#if TASKSYNC_SDT && defined(__has_include)
+#   if __has_include(<sys/sdt.h>)
+#       include <sys/sdt.h>
+#       define TASKSYNC_PROBE( name, synchronizer, running_tasks ) \
+            DTRACE_PROBE2( tasksync, name, static_cast<const void*>( synchronizer ), static_cast<int64_t>( running_tasks ) )
+#   endif
+#endif
+
+#if !defined(TASKSYNC_PROBE)
+#   define TASKSYNC_PROBE( name, synchronizer, running_tasks ) static_cast<void>( 0 )
+#endif
@@ -0,0 +1,701 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if TASKSYNC_IO_URING
+#   include <atomic>
+#   include <cstring>
+#   include <csignal>
+#   include <linux/io_uring.h>
+#   include <poll.h>
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+#endif
+
+namespace tasksync {
+
+    /// Readiness of a descriptor an operation of a Reactor waits for.
+    enum class ReactorDirection : uint8_t
+    {
+        read,
+        write,
+    };
+
+    /// How a Reactor waits for its descriptors.
+    enum class ReactorBackend : uint8_t
+    {
+        epoll,
+#if TASKSYNC_IO_URING
+        io_uring, ///< Only available if `TASKSYNC_IO_URING` is enabled (`config.tasksync.io_uring`).
+#endif
+    };
+
+    class Reactor;
+
+    namespace details {
+
+        class reactor_operation;
+
+        /// Cancels an operation of a reactor when its synchronizer is joined.
+        struct cancel_on_join
+        {
+            Reactor* reactor;
+            reactor_operation* operation;
+
+            void operator()() const noexcept;
+        };
+
+        /** Operation submitted to a reactor: waits for its descriptor to be ready, then performs its work as a
+            synchronized task. Every member but the work is protected by the mutex of the reactor.
+        */
+        class reactor_operation
+        {
+        public:
+            enum class state : uint8_t
+            {
+                submitting, ///< Not armed yet.
+                armed,      ///< Watched by the backend.
+                completing, ///< Found ready, its work being executed by the reactor.
+                cancelled,  ///< Cancelled by a join, freed by the reactor once the backend released it.
+                detached,   ///< Dropped by the destruction of the reactor.
+            };
+
+            reactor_operation( int fd, ReactorDirection direction ) : fd( fd ), direction( direction ) {}
+
+            virtual ~reactor_operation() = default;
+
+            reactor_operation( const reactor_operation& ) = delete;
+            reactor_operation& operator=( const reactor_operation& ) = delete;
+
+            /** Execute the work of the operation, unless its synchronizer is joined. Exceptions terminate.
+                @return true if the descriptor was not ready after all, the operation having to be armed again.
+            */
+            virtual bool complete() noexcept = 0;
+
+            const int fd;
+            const ReactorDirection direction;
+            state current = state::submitting;
+            reactor_operation* previous = nullptr; ///< In the operations of the reactor, once armed.
+            reactor_operation* next = nullptr;
+            std::optional<std::stop_callback<cancel_on_join>> on_join;
+        };
+
+        template< class Synched >
+        class reactor_operation_impl final : public reactor_operation
+        {
+        public:
+            reactor_operation_impl( int fd, ReactorDirection direction, Synched synched )
+                : reactor_operation( fd, direction )
+                , m_synched( std::move( synched ) )
+            {}
+
+            bool complete() noexcept override
+            {
+                bool not_ready = false;
+                m_synched( fd, not_ready );
+                return not_ready;
+            }
+
+        private:
+            Synched m_synched;
+        };
+
+        /// How a reactor watches descriptors. Only wait() is called without the mutex of the reactor locked.
+        class reactor_backend
+        {
+        public:
+            virtual ~reactor_backend() = default;
+
+            /** Start watching the descriptor of the operation. @return 0, or the error number of a failure. */
+            virtual int arm( reactor_operation& operation ) = 0;
+
+            /** Stop watching the descriptor of an armed operation.
+                @return true if the backend released the operation, false if collect() will report it once released.
+            */
+            virtual bool disarm( reactor_operation& operation ) = 0;
+
+            /** Block until descriptors are ready or the timeout expires, negative for none. Called by one thread at a time. */
+            virtual void wait( std::chrono::milliseconds timeout ) = 0;
+
+            /** Append the operations found ready by the last wait(), and the disarmed ones it released. */
+            virtual void collect( std::vector<reactor_operation*>& operations ) = 0;
+        };
+
+        inline std::system_error reactor_error( int error, const char* what )
+        {
+            return std::system_error{ error, std::system_category(), what };
+        }
+
+        /// Level-triggered epoll: each descriptor is registered once, for the directions of its armed operations.
+        class epoll_backend final : public reactor_backend
+        {
+        public:
+            epoll_backend() : m_epoll( ::epoll_create1( EPOLL_CLOEXEC ) )
+            {
+                if( m_epoll < 0 )
+                    throw reactor_error( errno, "epoll_create1" );
+            }
+
+            ~epoll_backend() override { ::close( m_epoll ); }
+
+            int arm( reactor_operation& operation ) override
+            {
+                auto& interest = m_interests[ operation.fd ];
+                auto& slot = interest.slot( operation.direction );
+                assert( !slot && "only one operation per direction of a descriptor can be pending" );
+                slot = &operation;
+                const auto error = update( operation.fd, interest );
+                if( error != 0 )
+                {
+                    slot = nullptr;
+                    if( !interest.registered )
+                        m_interests.erase( operation.fd );
+                }
+                return error;
+            }
+
+            bool disarm( reactor_operation& operation ) override
+            {
+                const auto found = m_interests.find( operation.fd );
+                assert( found != m_interests.end() );
+                found->second.slot( operation.direction ) = nullptr;
+                update( operation.fd, found->second );
+                return true;
+            }
+
+            void wait( std::chrono::milliseconds timeout ) override
+            {
+                const auto milliseconds = static_cast<int>( std::clamp<std::chrono::milliseconds::rep>( timeout.count(), -1, INT32_MAX ) );
+                m_ready = ::epoll_wait( m_epoll, m_events.data(), static_cast<int>( m_events.size() ), milliseconds );
+                if( m_ready < 0 ) // Interrupted.
+                    m_ready = 0;
+            }
+
+            void collect( std::vector<reactor_operation*>& operations ) override
+            {
+                for( const auto& event : std::span{ m_events }.first( static_cast<std::size_t>( m_ready ) ) )
+                {
+                    const auto found = m_interests.find( event.data.fd );
+                    if( found == m_interests.end() ) // Disarmed since.
+                        continue;
+                    auto& interest = found->second;
+                    if( interest.reader && ( event.events & ( EPOLLIN | EPOLLHUP | EPOLLERR ) ) )
+                        operations.push_back( std::exchange( interest.reader, nullptr ) );
+                    if( interest.writer && ( event.events & ( EPOLLOUT | EPOLLHUP | EPOLLERR ) ) )
+                        operations.push_back( std::exchange( interest.writer, nullptr ) );
+                    update( event.data.fd, interest );
+                }
+                m_ready = 0;
+            }
+
+        private:
+            struct interest
+            {
+                reactor_operation* reader = nullptr;
+                reactor_operation* writer = nullptr;
+                bool registered = false;
+
+                reactor_operation*& slot( ReactorDirection direction ) { return direction == ReactorDirection::read ? reader : writer; }
+            };
+
+            const int m_epoll;
+            std::unordered_map<int, interest> m_interests;
+            std::array<epoll_event, 128> m_events{};
+            int m_ready = 0;
+
+            /** Register the descriptor for the directions of its operations, or unregister and forget it if none. */
+            int update( int fd, interest& interest )
+            {
+                epoll_event event{};
+                event.events = ( interest.reader ? EPOLLIN : 0u ) | ( interest.writer ? EPOLLOUT : 0u );
+                event.data.fd = fd;
+                if( event.events == 0 )
+                {
+                    if( interest.registered )
+                        ::epoll_ctl( m_epoll, EPOLL_CTL_DEL, fd, nullptr ); // Fails if the descriptor was closed: nothing to remove.
+                    m_interests.erase( fd );
+                    return 0;
+                }
+                if( ::epoll_ctl( m_epoll, interest.registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event ) < 0 )
+                    return errno;
+                interest.registered = true;
+                return 0;
+            }
+        };
+
+#if TASKSYNC_IO_URING
+        /** io_uring through its system calls, without liburing: each operation is a one-shot poll request, cancelled
+            by a poll removal. The transfers are performed by the work of the operations, not by the kernel: a join
+            never has to wait for the kernel to stop writing to the buffer of an operation.
+        */
+        class uring_backend final : public reactor_backend
+        {
+        public:
+            explicit uring_backend( unsigned entries = 256 )
+            {
+                io_uring_params params{};
+                m_ring = static_cast<int>( ::syscall( __NR_io_uring_setup, entries, &params ) );
+                if( m_ring < 0 )
+                    throw reactor_error( errno, "io_uring_setup" );
+                if( !( params.features & IORING_FEAT_SINGLE_MMAP ) || !( params.features & IORING_FEAT_EXT_ARG )
+                    || !( params.features & IORING_FEAT_NODROP ) )
+                {
+                    ::close( m_ring );
+                    throw reactor_error( ENOSYS, "io_uring features" );
+                }
+
+                m_rings_size = std::max( params.sq_off.array + params.sq_entries * sizeof( unsigned ),
+                                         params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe ) );
+                m_rings = ::mmap( nullptr, m_rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING );
+                m_sqes_size = params.sq_entries * sizeof( io_uring_sqe );
+                void* sqes = ::mmap( nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES );
+                if( m_rings == MAP_FAILED || sqes == MAP_FAILED )
+                {
+                    const auto error = errno;
+                    unmap( sqes );
+                    throw reactor_error( error, "io_uring mmap" );
+                }
+
+                auto* const rings = static_cast<std::byte*>( m_rings );
+                m_sq_head = reinterpret_cast<unsigned*>( rings + params.sq_off.head );
+                m_sq_tail = reinterpret_cast<unsigned*>( rings + params.sq_off.tail );
+                m_sq_mask = *reinterpret_cast<unsigned*>( rings + params.sq_off.ring_mask );
+                m_sq_entries = params.sq_entries;
+                m_sq_array = reinterpret_cast<unsigned*>( rings + params.sq_off.array );
+                m_sqes = static_cast<io_uring_sqe*>( sqes );
+                m_cq_head = reinterpret_cast<unsigned*>( rings + params.cq_off.head );
+                m_cq_tail = reinterpret_cast<unsigned*>( rings + params.cq_off.tail );
+                m_cq_mask = *reinterpret_cast<unsigned*>( rings + params.cq_off.ring_mask );
+                m_cqes = reinterpret_cast<io_uring_cqe*>( rings + params.cq_off.cqes );
+            }
+
+            ~uring_backend() override { unmap( m_sqes ); }
+
+            int arm( reactor_operation& operation ) override
+            {
+                auto& sqe = next_sqe();
+                sqe.opcode = IORING_OP_POLL_ADD;
+                sqe.fd = operation.fd;
+                sqe.poll32_events = operation.direction == ReactorDirection::read ? POLLIN : POLLOUT;
+                sqe.user_data = reinterpret_cast<uintptr_t>( &operation );
+                return submit();
+            }
+
+            bool disarm( reactor_operation& operation ) override
+            {
+                auto& sqe = next_sqe();
+                sqe.opcode = IORING_OP_POLL_REMOVE;
+                sqe.addr = reinterpret_cast<uintptr_t>( &operation );
+                sqe.user_data = 0; // Its own completion is ignored, the poll completes as cancelled.
+                if( submit() != 0 ) // Retried by collect(), once completions are reaped.
+                    m_unremoved.push_back( &operation );
+                return false;
+            }
+
+            void wait( std::chrono::milliseconds timeout ) override
+            {
+                if( timeout.count() == 0 || completions_available() )
+                    return;
+
+                __kernel_timespec timespec{};
+                timespec.tv_sec = timeout.count() / 1000;
+                timespec.tv_nsec = ( timeout.count() % 1000 ) * 1'000'000;
+                io_uring_getevents_arg argument{};
+                argument.sigmask_sz = _NSIG / 8;
+                argument.ts = reinterpret_cast<uintptr_t>( &timespec );
+                const bool bounded = timeout.count() > 0;
+                // Errors are interruptions and expired timeouts: the completions are collected anyway.
+                ::syscall( __NR_io_uring_enter, m_ring, 0, 1, IORING_ENTER_GETEVENTS | ( bounded ? IORING_ENTER_EXT_ARG : 0u ),
+                           bounded ? &argument : nullptr, bounded ? sizeof( argument ) : 0 );
+            }
+
+            void collect( std::vector<reactor_operation*>& operations ) override
+            {
+                auto head = *m_cq_head; // Only written by this thread.
+                const auto tail = std::atomic_ref{ *m_cq_tail }.load( std::memory_order_acquire );
+                for( ; head != tail; ++head )
+                {
+                    const auto& cqe = m_cqes[ head & m_cq_mask ];
+                    if( cqe.user_data != 0 )
+                    {
+                        auto* operation = reinterpret_cast<reactor_operation*>( static_cast<uintptr_t>( cqe.user_data ) );
+                        std::erase( m_unremoved, operation ); // Its poll completed anyway: it is released.
+                        operations.push_back( operation );
+                    }
+                }
+                std::atomic_ref{ *m_cq_head }.store( head, std::memory_order_release );
+
+                auto unremoved = std::exchange( m_unremoved, {} );
+                for( auto* operation : unremoved )
+                    disarm( *operation );
+            }
+
+        private:
+            int m_ring = -1;
+            void* m_rings = MAP_FAILED;
+            std::size_t m_rings_size = 0;
+            std::size_t m_sqes_size = 0;
+            unsigned* m_sq_head = nullptr;
+            unsigned* m_sq_tail = nullptr;
+            unsigned m_sq_mask = 0;
+            unsigned m_sq_entries = 0;
+            unsigned* m_sq_array = nullptr;
+            io_uring_sqe* m_sqes = nullptr;
+            unsigned* m_cq_head = nullptr;
+            unsigned* m_cq_tail = nullptr;
+            unsigned m_cq_mask = 0;
+            io_uring_cqe* m_cqes = nullptr;
+            std::vector<reactor_operation*> m_unremoved; ///< Disarmed ones whose removal could not be submitted yet.
+
+            void unmap( void* sqes )
+            {
+                if( sqes != MAP_FAILED && sqes != nullptr )
+                    ::munmap( sqes, m_sqes_size );
+                if( m_rings != MAP_FAILED )
+                    ::munmap( m_rings, m_rings_size );
+                ::close( m_ring );
+            }
+
+            bool completions_available() const
+            {
+                return *m_cq_head != std::atomic_ref{ *m_cq_tail }.load( std::memory_order_acquire );
+            }
+
+            /// Called with the reactor locked: each entry is submitted right away, so the queue is empty.
+            io_uring_sqe& next_sqe()
+            {
+                const auto index = *m_sq_tail & m_sq_mask;
+                assert( *m_sq_tail - std::atomic_ref{ *m_sq_head }.load( std::memory_order_acquire ) < m_sq_entries );
+                auto& sqe = m_sqes[ index ];
+                std::memset( &sqe, 0, sizeof( sqe ) );
+                m_sq_array[ index ] = index;
+                return sqe;
+            }
+
+            /** Submit the entry prepared by next_sqe(). Not retried on EAGAIN nor EBUSY: only run_once() reaps the
+                completions the kernel is waiting for, and it needs the mutex of the reactor held by the caller.
+                @return 0, or the error number, the entry being dropped.
+            */
+            int submit()
+            {
+                const auto tail = *m_sq_tail;
+                std::atomic_ref{ *m_sq_tail }.store( tail + 1, std::memory_order_release );
+                while( ::syscall( __NR_io_uring_enter, m_ring, 1, 0, 0u, nullptr, 0 ) < 0 )
+                {
+                    if( errno != EINTR )
+                    {
+                        const auto error = errno;
+                        // Nothing is consumed on failure, and the kernel only reads the tail when entered.
+                        std::atomic_ref{ *m_sq_tail }.store( tail, std::memory_order_release );
+                        return error;
+                    }
+                }
+                return 0;
+            }
+        };
+#endif
+
+    }
+
+    /** Linux I/O reactor, every operation of which is bound to a TaskSynchronizer: once a joining function of that
+        synchronizer is called, its operations still waiting for their descriptor are cancelled, and the work of those
+        found ready meanwhile is skipped. The join only waits for the handlers being executed, like for any synchronized task.
+
+        The reads and writes are performed when the descriptor is ready, just before the handler and as the same
+        synchronized task: the buffer of an operation is never accessed once its synchronizer is joined, so it can
+        be a member of the object owning the synchronizer.
+
+        Operations can be submitted from any thread, including from handlers; run_once() waits for the descriptors
+        and executes the handlers on the calling thread, and must not be called concurrently. Descriptors must be
+        non-blocking, and at most one operation per direction can be pending for a descriptor. Submitting allocates
+        the operation, nothing else. Exceptions escaping handlers terminate.
+    */
+    class Reactor
+    {
+    public:
+        /** @param backend How descriptors are watched.
+            Throws `std::system_error` if the backend cannot be created.
+        */
+        explicit Reactor( ReactorBackend backend = ReactorBackend::epoll )
+            : m_backend( make_backend( backend ) )
+        {}
+
+        /** Destructor, dropping the pending operations without executing them. */
+        ~Reactor()
+        {
+            std::vector<details::reactor_operation*> dropped;
+            {
+                std::scoped_lock lock{ m_mutex };
+                // Joins may still cancel them until they are destroyed, but must leave them alone.
+                for( auto* operation = m_operations; operation; operation = operation->next )
+                {
+                    operation->current = state::detached;
+                    dropped.push_back( operation );
+                }
+                m_operations = nullptr;
+                dropped.insert( dropped.end(), m_released.begin(), m_released.end() );
+                m_released.clear();
+                m_pending = 0;
+            }
+            for( auto* operation : dropped )
+                delete operation;
+        }
+
+        Reactor( const Reactor& ) = delete;
+        Reactor& operator=( const Reactor& ) = delete;
+
+        /** Read from `fd` into `buffer` once it is readable, then call `handler( result )` with the number of bytes
+            read (0 at the end of the input) or the negated error number, unless `owner` is joined before.
+            @return false if `owner` is already joined, in which case nothing is done.
+            Throws `std::system_error` if the descriptor cannot be watched.
+            @see TaskSynchronizer::synchronized()
+        */
+        template< class Handler >
+        bool async_read( TaskSynchronizer& owner, int fd, std::span<std::byte> buffer, Handler&& handler,
+                         details::task_location location = details::task_location::current() )
+        {
+            return submit( owner, fd, ReactorDirection::read, [ buffer, handler = std::forward<Handler>( handler ) ]( int fd, bool& not_ready ) mutable {
+                const auto result = transfer( not_ready, [&]{ return ::read( fd, buffer.data(), buffer.size() ); } );
+                if( !not_ready )
+                    std::invoke( handler, result );
+            }, location );
+        }
+
+        /** Write `buffer` to `fd` once it is writable, then call `handler( result )` with the number of bytes written,
+            possibly less than the size of the buffer, or the negated error number, unless `owner` is joined before.
+            @see async_read()
+        */
+        template< class Handler >
+        bool async_write( TaskSynchronizer& owner, int fd, std::span<const std::byte> buffer, Handler&& handler,
+                          details::task_location location = details::task_location::current() )
+        {
+            return submit( owner, fd, ReactorDirection::write, [ buffer, handler = std::forward<Handler>( handler ) ]( int fd, bool& not_ready ) mutable {
+                const auto result = transfer( not_ready, [&]{ return ::write( fd, buffer.data(), buffer.size() ); } );
+                if( !not_ready )
+                    std::invoke( handler, result );
+            }, location );
+        }
+
+        /** Call `handler()` once `fd` is ready in the given direction, unless `owner` is joined before: to accept
+            connections, or complete them for example.
+            @see async_read()
+        */
+        template< class Handler >
+        bool async_wait( TaskSynchronizer& owner, int fd, ReactorDirection direction, Handler&& handler,
+                         details::task_location location = details::task_location::current() )
+        {
+            return submit( owner, fd, direction, [ handler = std::forward<Handler>( handler ) ]( int, bool& ) mutable {
+                std::invoke( handler );
+            }, location );
+        }
+
+        /** Wait until descriptors are ready or `timeout` expires, then execute the operations found ready.
+            @param timeout Maximum duration to wait, zero to only execute the operations already ready, negative to
+                           wait for one.
+            @return Number of operations which ended, executed or skipped because their synchronizer was joined.
+        */
+        std::size_t run_once( std::chrono::milliseconds timeout = std::chrono::milliseconds{ -1 } )
+        {
+            free_released();
+            m_backend->wait( timeout );
+
+            m_ready.clear();
+            {
+                std::scoped_lock lock{ m_mutex };
+                m_backend->collect( m_ready );
+                for( auto& operation : m_ready )
+                {
+                    if( operation->current == state::armed )
+                        operation->current = state::completing;
+                    else // Released after being cancelled.
+                    {
+                        unlink( *operation );
+                        m_released.push_back( std::exchange( operation, nullptr ) );
+                    }
+                }
+            }
+
+            std::size_t ended = 0;
+            for( auto* operation : m_ready )
+            {
+                if( !operation )
+                    continue;
+                const bool not_ready = operation->complete();
+                {
+                    std::scoped_lock lock{ m_mutex };
+                    if( not_ready && operation->current == state::completing && m_backend->arm( *operation ) == 0 )
+                    {
+                        operation->current = state::armed;
+                        continue;
+                    }
+                    unlink( *operation );
+                    --m_pending;
+                }
+                delete operation; // Unlocked: destroying its stop callback waits for it if it is being invoked.
+                ++ended;
+            }
+            free_released();
+            return ended;
+        }
+
+        /** @return Number of operations submitted which did not end nor were cancelled yet. */
+        std::size_t pending() const
+        {
+            std::scoped_lock lock{ m_mutex };
+            return m_pending;
+        }
+
+    private:
+        friend struct details::cancel_on_join;
+        using state = details::reactor_operation::state;
+
+        const std::unique_ptr<details::reactor_backend> m_backend;
+        mutable std::mutex m_mutex;
+        details::reactor_operation* m_operations = nullptr; ///< Armed or completing ones, protected by m_mutex.
+        std::vector<details::reactor_operation*> m_released; ///< Cancelled and released by the backend, protected by m_mutex.
+        std::size_t m_pending = 0; ///< Protected by m_mutex.
+        std::vector<details::reactor_operation*> m_ready; ///< Only used by run_once().
+
+        static std::unique_ptr<details::reactor_backend> make_backend( ReactorBackend backend )
+        {
+#if TASKSYNC_IO_URING
+            if( backend == ReactorBackend::io_uring )
+                return std::make_unique<details::uring_backend>();
+#endif
+            assert( backend == ReactorBackend::epoll );
+            return std::make_unique<details::epoll_backend>();
+        }
+
+        /** Perform a read or write.
+            @return The result of the transfer, or the negated error number. `not_ready` is set if it would block.
+        */
+        template< class Transfer >
+        static ssize_t transfer( bool& not_ready, Transfer&& transfer )
+        {
+            ssize_t result;
+            do
+                result = transfer();
+            while( result < 0 && errno == EINTR );
+            if( result >= 0 )
+                return result;
+            not_ready = errno == EAGAIN || errno == EWOULDBLOCK;
+            return -errno;
+        }
+
+        template< class Work >
+        bool submit( TaskSynchronizer& owner, int fd, ReactorDirection direction, Work&& work, details::task_location location )
+        {
+            auto synched = owner.synchronized( std::forward<Work>( work ), location );
+            auto* operation = new details::reactor_operation_impl<decltype( synched )>{ fd, direction, std::move( synched ) };
+            // Registered before locking: if the owner is already joined, the operation is cancelled right away.
+            operation->on_join.emplace( owner.get_stop_token(), details::cancel_on_join{ this, operation } );
+
+            int error = 0;
+            {
+                std::scoped_lock lock{ m_mutex };
+                if( operation->current == state::submitting )
+                {
+                    error = m_backend->arm( *operation );
+                    if( error == 0 )
+                    {
+                        operation->current = state::armed;
+                        link( *operation );
+                        ++m_pending;
+                        return true;
+                    }
+                    operation->current = state::cancelled;
+                }
+            }
+            delete operation;
+            if( error != 0 )
+                throw details::reactor_error( error, "tasksync::Reactor: cannot watch the descriptor" );
+            return false;
+        }
+
+        void cancel( details::reactor_operation& operation ) noexcept
+        {
+            std::scoped_lock lock{ m_mutex };
+            switch( operation.current )
+            {
+            case state::armed:
+                operation.current = state::cancelled;
+                --m_pending;
+                if( m_backend->disarm( operation ) )
+                {
+                    unlink( operation );
+                    m_released.push_back( &operation );
+                }
+                break;
+            case state::submitting: // Freed by the submitting thread.
+            case state::completing: // Freed by run_once(), its work being skipped.
+                operation.current = state::cancelled;
+                break;
+            case state::cancelled:
+            case state::detached:
+                break;
+            }
+        }
+
+        /** Destroy the operations released after being cancelled, unlocked. */
+        void free_released()
+        {
+            std::vector<details::reactor_operation*> released;
+            {
+                std::scoped_lock lock{ m_mutex };
+                if( m_released.empty() )
+                    return;
+                std::swap( released, m_released );
+            }
+            for( auto* operation : released )
+                delete operation;
+        }
+
+        void link( details::reactor_operation& operation )
+        {
+            operation.next = m_operations;
+            if( m_operations )
+                m_operations->previous = &operation;
+            m_operations = &operation;
+        }
+
+        void unlink( details::reactor_operation& operation )
+        {
+            if( operation.previous )
+                operation.previous->next = operation.next;
+            else
+                m_operations = operation.next;
+            if( operation.next )
+                operation.next->previous = operation.previous;
+            operation.previous = operation.next = nullptr;
+        }
+    };
+
+    inline void details::cancel_on_join::operator()() const noexcept { reactor->cancel( *operation ); }
+
+}
+
+#endif
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <tasksync/config.hpp>
+#include <tasksync/stats.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace tasksync {
+
+    class TaskSynchronizer;
+
+    /** Joining progress of a TaskSynchronizer. */
+    enum class JoinState : uint8_t
+    {
+        not_joined, ///< Synchronized tasks are executed.
+        joining,    ///< A join is waiting for running tasks to end.
+        joined,     ///< Synchronized tasks are not executed anymore.
+    };
+
+    namespace details {
+
+        class synchronizer_registry;
+
+        /** Registration of a TaskSynchronizer in the process-wide registry, for the lifetime of this object. */
+        class registered_synchronizer
+        {
+        public:
+            explicit registered_synchronizer( const TaskSynchronizer& synchronizer );
+            ~registered_synchronizer();
+
+            registered_synchronizer( const registered_synchronizer& ) = delete;
+            registered_synchronizer& operator=( const registered_synchronizer& ) = delete;
+
+            const TaskSynchronizer& synchronizer() const { return m_synchronizer; }
+
+            void set_join_state( JoinState state ) { m_join_state.store( state, std::memory_order_relaxed ); }
+            JoinState join_state() const { return m_join_state.load( std::memory_order_relaxed ); }
+
+            void set_name( const char* name ) { m_name.store( name, std::memory_order_relaxed ); }
+            const char* name() const { return m_name.load( std::memory_order_relaxed ); }
+
+        private:
+            friend class synchronizer_registry;
+
+            const TaskSynchronizer& m_synchronizer;
+            std::atomic<JoinState> m_join_state{ JoinState::not_joined };
+            std::atomic<const char*> m_name{ nullptr };
+
+            std::size_t m_shard;
+            registered_synchronizer* m_previous = nullptr;
+            registered_synchronizer* m_next = nullptr;
+        };
+
+        /** Process-wide list of the existing synchronizers.
+
+            Synchronizers are only linked and unlinked on construction and destruction, never while executing tasks.
+            The list is split in shards, each with its own mutex, chosen by the constructing thread so that
+            threads creating and destroying synchronizers concurrently rarely contend.
+        */
+        class synchronizer_registry
+        {
+        public:
+
+            static synchronizer_registry& instance()
+            {
+                static synchronizer_registry registry;
+                return registry;
+            }
+
+            /** Call `visitor` with each registered synchronizer, which cannot be destroyed during the call. */
+            template< class Visitor >
+            void visit( Visitor&& visitor )
+            {
+                for( auto& shard : m_shards )
+                {
+                    std::scoped_lock lock{ shard.mutex };
+                    for( auto* entry = shard.head; entry; entry = entry->m_next )
+                        visitor( std::as_const( *entry ) );
+                }
+            }
+
+        private:
+            friend class registered_synchronizer;
+
+            struct alignas( cache_line_size ) Shard
+            {
+                std::mutex mutex;
+                registered_synchronizer* head = nullptr;
+            };
+
+            std::array<Shard, TASKSYNC_REGISTRY_SHARDS> m_shards;
+
+            void link( registered_synchronizer& entry )
+            {
+                entry.m_shard = this_thread_index() % m_shards.size();
+                auto& shard = m_shards[ entry.m_shard ];
+                std::scoped_lock lock{ shard.mutex };
+                entry.m_next = shard.head;
+                if( shard.head )
+                    shard.head->m_previous = &entry;
+                shard.head = &entry;
+            }
+
+            void unlink( registered_synchronizer& entry )
+            {
+                auto& shard = m_shards[ entry.m_shard ];
+                std::scoped_lock lock{ shard.mutex };
+                if( entry.m_previous )
+                    entry.m_previous->m_next = entry.m_next;
+                else
+                    shard.head = entry.m_next;
+                if( entry.m_next )
+                    entry.m_next->m_previous = entry.m_previous;
+            }
+        };
+
+        inline registered_synchronizer::registered_synchronizer( const TaskSynchronizer& synchronizer )
+            : m_synchronizer( synchronizer )
+        {
+            synchronizer_registry::instance().link( *this );
+        }
+
+        inline registered_synchronizer::~registered_synchronizer()
+        {
+            synchronizer_registry::instance().unlink( *this );
+        }
+
+    }
+}
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <tasksync/config.hpp>
+#include <tasksync/per_thread.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+#if TASKSYNC_CALL_SITES
+#   include <tasksync/call_sites.hpp>
+#endif
+
+#if defined(__linux__)
+#   include <time.h>
+#endif
+
+namespace tasksync {
+
+    class TaskSynchronizer;
+
+    /** Description of a synchronized task body being executed.
+        @see visit_running_tasks(), dump_running()
+    */
+    struct RunningTask
+    {
+        /// Synchronizer of the task.
+        const TaskSynchronizer* synchronizer = nullptr;
+
+        /// Thread executing the task.
+        std::thread::id thread;
+
+        /// When the task body began, with a coarse resolution (a few milliseconds).
+        std::chrono::steady_clock::time_point start;
+
+        /// Label provided to TaskSynchronizer::synchronized(), null if none was provided.
+        const char* label = nullptr;
+
+#if TASKSYNC_CALL_SITES
+        /// Location of the TaskSynchronizer::synchronized() call which wrapped the task.
+        std::source_location location;
+#endif
+    };
+
+    /** Description of a join waiting for the running tasks of its synchronizer to end.
+        @see visit_running_joins(), dump_running()
+    */
+    struct RunningJoin
+    {
+        /// Synchronizer being joined.
+        const TaskSynchronizer* synchronizer = nullptr;
+
+        /// Thread waiting for the join.
+        std::thread::id thread;
+
+        /// When the join began, with a coarse resolution (a few milliseconds).
+        std::chrono::steady_clock::time_point start;
+
+        /// Number of tasks the join was waiting for when visited.
+        int64_t running_tasks = 0;
+    };
+
+    namespace details {
+
+#if TASKSYNC_CALL_SITES
+        using running_call_site = const call_site*;
+#else
+        using running_call_site = const void*;
+#endif
+
+        /** @return The current time of the steady clock, with a coarse resolution but cheaper to read. */
+        inline std::chrono::steady_clock::time_point coarse_now()
+        {
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+            // std::chrono::steady_clock is CLOCK_MONOTONIC, which has the same origin.
+            timespec now;
+            ::clock_gettime( CLOCK_MONOTONIC_COARSE, &now );
+            return std::chrono::steady_clock::time_point{ std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::seconds{ now.tv_sec } + std::chrono::nanoseconds{ now.tv_nsec } ) };
+#else
+            return std::chrono::steady_clock::now();
+#endif
+        }
+
+        /** Running synchronized tasks of one thread, readable from any thread without locking.
+
+            Tasks executed by a thread are nested, so they are pushed and popped like a stack.
+            Each slot is protected by a sequence number (like a seqlock): readers retry or skip
+            slots being written instead of blocking the owning thread.
+        */
+        class running_task_slots
+        {
+        public:
+            static constexpr std::size_t capacity = TASKSYNC_RUNNING_REGISTRY_DEPTH;
+
+            void push( const TaskSynchronizer* synchronizer, const char* label, running_call_site call_site )
+            {
+                const auto depth = m_depth.load( std::memory_order_relaxed );
+                if( depth < capacity )
+                {
+                    auto& slot = m_slots[ depth ];
+                    const auto sequence = slot.sequence.load( std::memory_order_relaxed );
+                    slot.sequence.store( sequence + 1, std::memory_order_relaxed );
+                    std::atomic_thread_fence( std::memory_order_release );
+                    slot.synchronizer.store( synchronizer, std::memory_order_relaxed );
+                    slot.start.store( coarse_now().time_since_epoch().count(), std::memory_order_relaxed );
+                    slot.label.store( label, std::memory_order_relaxed );
+                    slot.call_site.store( call_site, std::memory_order_relaxed );
+                    slot.sequence.store( sequence + 2, std::memory_order_release );
+                }
+                m_depth.store( depth + 1, std::memory_order_release );
+            }
+
+            void pop()
+            {
+                m_depth.store( m_depth.load( std::memory_order_relaxed ) - 1, std::memory_order_release );
+            }
+
+            /** Call `visitor` with each task in use, from the outermost task to the innermost. */
+            template< class Visitor >
+            void visit( Visitor&& visitor ) const
+            {
+                auto depth = m_depth.load( std::memory_order_acquire );
+                if( depth > capacity )
+                    depth = capacity;
+
+                for( std::size_t index = 0; index < depth; ++index )
+                {
+                    const auto& slot = m_slots[ index ];
+                    const auto sequence = slot.sequence.load( std::memory_order_acquire );
+                    if( sequence % 2 != 0 ) // Being written.
+                        continue;
+
+                    RunningTask task;
+                    task.synchronizer = slot.synchronizer.load( std::memory_order_relaxed );
+                    task.thread = m_thread.load( std::memory_order_relaxed );
+                    task.start = std::chrono::steady_clock::time_point{ std::chrono::steady_clock::duration{ slot.start.load( std::memory_order_relaxed ) } };
+                    task.label = slot.label.load( std::memory_order_relaxed );
+                    const auto call_site = slot.call_site.load( std::memory_order_relaxed );
+
+                    std::atomic_thread_fence( std::memory_order_acquire );
+                    if( slot.sequence.load( std::memory_order_relaxed ) != sequence
+                        || index >= m_depth.load( std::memory_order_relaxed ) ) // Reused or popped meanwhile.
+                        continue;
+
+#if TASKSYNC_CALL_SITES
+                    if( call_site )
+                        task.location = call_site->location();
+#else
+                    (void)call_site;
+#endif
+                    visitor( task );
+                }
+            }
+
+            void attach_to_this_thread()
+            {
+                m_thread.store( std::this_thread::get_id(), std::memory_order_relaxed );
+                m_depth.store( 0, std::memory_order_relaxed );
+            }
+
+        private:
+
+            struct Slot
+            {
+                std::atomic<uint32_t> sequence{ 0 };
+                std::atomic<const TaskSynchronizer*> synchronizer{ nullptr };
+                std::atomic<std::chrono::steady_clock::rep> start{ 0 };
+                std::atomic<const char*> label{ nullptr };
+                std::atomic<running_call_site> call_site{ nullptr };
+            };
+
+            std::array<Slot, capacity> m_slots;
+            std::atomic<std::size_t> m_depth{ 0 };
+            std::atomic<std::thread::id> m_thread;
+        };
+
+        /// Running task slots of all the threads.
+        using running_task_registry = per_thread_registry<running_task_slots>;
+
+        inline void print_running_task_line( std::ostream& out, const RunningTask& task, std::chrono::steady_clock::time_point now )
+        {
+            const auto running_time = std::chrono::duration_cast<std::chrono::milliseconds>( now - task.start );
+            out << "synchronizer " << static_cast<const void*>( task.synchronizer )
+                << " thread " << task.thread
+                << " running for " << running_time.count() << "ms";
+            if( task.label )
+                out << " '" << task.label << "'";
+#if TASKSYNC_CALL_SITES
+            if( task.location.line() != 0 )
+                out << " at " << task.location.file_name() << ':' << task.location.line() << " (" << task.location.function_name() << ')';
+#endif
+            out << '\n';
+        }
+
+        /** Process-wide list of the joins waiting for running tasks.
+
+            Joins are rare and already blocking, so unlike running tasks they are simply linked under a mutex.
+        */
+        class running_join_registry
+        {
+        public:
+
+            /** Registers a join for the lifetime of this object, which must not outlive the synchronizer. */
+            class scope
+            {
+            public:
+                scope( const TaskSynchronizer* synchronizer, const std::atomic<int64_t>& running_tasks )
+                    : m_synchronizer( synchronizer ), m_running_tasks( running_tasks )
+                    , m_thread( std::this_thread::get_id() ), m_start( coarse_now() )
+                {
+                    instance().link( *this );
+                }
+
+                ~scope() { instance().unlink( *this ); }
+
+                scope( const scope& ) = delete;
+                scope& operator=( const scope& ) = delete;
+
+            private:
+                friend class running_join_registry;
+
+                const TaskSynchronizer* m_synchronizer;
+                const std::atomic<int64_t>& m_running_tasks;
+                std::thread::id m_thread;
+                std::chrono::steady_clock::time_point m_start;
+                scope* m_previous = nullptr;
+                scope* m_next = nullptr;
+            };
+
+            static running_join_registry& instance()
+            {
+                static running_join_registry registry;
+                return registry;
+            }
+
+            template< class Visitor >
+            void visit( Visitor&& visitor )
+            {
+                std::scoped_lock lock{ m_mutex };
+                for( auto* join = m_head; join; join = join->m_next )
+                {
+                    RunningJoin running_join;
+                    running_join.synchronizer = join->m_synchronizer;
+                    running_join.thread = join->m_thread;
+                    running_join.start = join->m_start;
+                    running_join.running_tasks = join->m_running_tasks.load();
+                    visitor( running_join );
+                }
+            }
+
+        private:
+            std::mutex m_mutex;
+            scope* m_head = nullptr;
+
+            void link( scope& join )
+            {
+                std::scoped_lock lock{ m_mutex };
+                join.m_next = m_head;
+                if( m_head )
+                    m_head->m_previous = &join;
+                m_head = &join;
+            }
+
+            void unlink( scope& join )
+            {
+                std::scoped_lock lock{ m_mutex };
+                if( join.m_previous )
+                    join.m_previous->m_next = join.m_next;
+                else
+                    m_head = join.m_next;
+                if( join.m_next )
+                    join.m_next->m_previous = join.m_previous;
+            }
+        };
+
+        inline void print_running_join_line( std::ostream& out, const RunningJoin& join, std::chrono::steady_clock::time_point now )
+        {
+            const auto waiting_time = std::chrono::duration_cast<std::chrono::milliseconds>( now - join.start );
+            out << "synchronizer " << static_cast<const void*>( join.synchronizer )
+                << " thread " << join.thread
+                << " joining for " << waiting_time.count() << "ms"
+                << ", waiting for " << join.running_tasks << " running tasks\n";
+        }
+    }
+
+    /** Call `visitor` with a description (`const RunningTask&`) of each synchronized task body being executed,
+        by any thread and for any synchronizer.
+
+        Running tasks are read without locking nor allocating, so a watchdog thread visiting them never blocks the
+        threads executing tasks. Tasks beginning or ending during the visit may be missed.
+        Only available if `TASKSYNC_RUNNING_REGISTRY` is enabled (`config.tasksync.running_registry`).
+    */
+    template< class Visitor >
+    void visit_running_tasks( Visitor&& visitor )
+    {
+        details::running_task_registry::instance().visit_in_use( [&]( const details::running_task_slots& slots ) {
+            slots.visit( visitor );
+        } );
+    }
+
+    /** Call `visitor` with a description (`const RunningJoin&`) of each join waiting for running tasks to end.
+
+        Unlike visit_running_tasks(), this locks a mutex shared with beginning and ending joins.
+        Only available if `TASKSYNC_RUNNING_REGISTRY` is enabled (`config.tasksync.running_registry`).
+    */
+    template< class Visitor >
+    void visit_running_joins( Visitor&& visitor )
+    {
+        details::running_join_registry::instance().visit( visitor );
+    }
+
+    /** Print a line describing each synchronized task body being executed and each join waiting for them,
+        by any thread and for any synchronizer.
+
+        This locks the mutex of the joins and formats to `out`: it must not be called from a signal handler.
+        @see visit_running_tasks(), visit_running_joins()
+    */
+    inline void dump_running( std::ostream& out )
+    {
+        const auto now = details::coarse_now();
+        visit_running_tasks( [&]( const RunningTask& task ) {
+            details::print_running_task_line( out, task, now );
+        } );
+        visit_running_joins( [&]( const RunningJoin& join ) {
+            details::print_running_join_line( out, join, now );
+        } );
+    }
+
+}
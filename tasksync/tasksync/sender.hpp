@@ -0,0 +1,320 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+// Sender/receiver adaptors, following the member function protocol of std::execution (P2300, C++26):
+// a sender is connected to a receiver by `std::move( sender ).connect( receiver )`, which returns an
+// operation state; `operation.start()` begins the work, which ends by one of `std::move( receiver ).set_value( values... )`,
+// `.set_error( error )` or `.set_stopped()`. No implementation of std::execution is required.
+
+namespace tasksync {
+
+    namespace details {
+
+        /// Starts an operation as a synchronized task, telling whether it was not skipped.
+        struct start_operation
+        {
+            template< class Operation >
+            void operator()( Operation& operation, bool& started ) const noexcept
+            {
+                started = true;
+                operation.start();
+            }
+        };
+
+        using synchronized_start = decltype( std::declval<TaskSynchronizer&>().synchronized( start_operation{} ) );
+
+        /// Forwards the completion of an operation to the receiver of an enclosing one.
+        template< class Operation >
+        struct forwarding_receiver
+        {
+            Operation* operation;
+
+            template< class... Values >
+            void set_value( Values&&... values ) && noexcept { std::move( operation->m_receiver ).set_value( std::forward<Values>( values )... ); }
+
+            template< class Error >
+            void set_error( Error&& error ) && noexcept { std::move( operation->m_receiver ).set_error( std::forward<Error>( error ) ); }
+
+            void set_stopped() && noexcept { std::move( operation->m_receiver ).set_stopped(); }
+
+            decltype( auto ) get_env() const noexcept
+                requires requires( const typename Operation::receiver_type& receiver ) { receiver.get_env(); }
+            {
+                return operation->m_receiver.get_env();
+            }
+        };
+    }
+
+    /** Sender adaptor: starts the adapted sender as a synchronized task, or completes with `set_stopped()` if the
+        synchronizer is joined before the work starts.
+
+        A join waits for the call starting the adapted operation, not for its completion: use an AsyncScope to know
+        when the work started through it ends.
+        @see tasksync::synchronized(), TaskSynchronizer::synchronized()
+    */
+    template< class Sender >
+    class SynchronizedSender
+    {
+    public:
+        SynchronizedSender( TaskSynchronizer& task_sync, Sender sender )
+            : m_task_sync( &task_sync )
+            , m_sender( std::move( sender ) )
+        {}
+
+        template< class Receiver >
+        class Operation
+        {
+        public:
+            using receiver_type = Receiver;
+
+            Operation( TaskSynchronizer& task_sync, Sender&& sender, Receiver receiver )
+                : m_receiver( std::move( receiver ) )
+                , m_start( task_sync.synchronized( details::start_operation{} ) )
+                , m_operation( std::move( sender ).connect( details::forwarding_receiver<Operation>{ this } ) )
+            {}
+
+            Operation( const Operation& ) = delete;
+            Operation& operator=( const Operation& ) = delete;
+
+            void start() & noexcept
+            {
+                // Invoked from a copy: the adapted operation can complete, and this one be destroyed, before it returns.
+                auto synched_start = m_start;
+                bool started = false;
+                synched_start( m_operation, started );
+                if( !started )
+                    std::move( m_receiver ).set_stopped();
+            }
+
+        private:
+            friend struct details::forwarding_receiver<Operation>;
+
+            using InnerOperation = decltype( std::declval<Sender>().connect( std::declval<details::forwarding_receiver<Operation>>() ) );
+
+            Receiver m_receiver;
+            details::synchronized_start m_start;
+            InnerOperation m_operation;
+        };
+
+        template< class Receiver >
+        Operation<Receiver> connect( Receiver receiver ) &&
+        {
+            return Operation<Receiver>{ *m_task_sync, std::move( m_sender ), std::move( receiver ) };
+        }
+
+        template< class Receiver >
+        Operation<Receiver> connect( Receiver receiver ) const &
+            requires std::is_copy_constructible_v<Sender>
+        {
+            return Operation<Receiver>{ *m_task_sync, Sender{ m_sender }, std::move( receiver ) };
+        }
+
+    private:
+        TaskSynchronizer* m_task_sync;
+        Sender m_sender;
+    };
+
+    /** @return A sender starting `sender` as a synchronized task, completing with `set_stopped()` if `task_sync`
+                is joined before. @see SynchronizedSender
+    */
+    template< class Sender >
+    SynchronizedSender<std::decay_t<Sender>> synchronized( TaskSynchronizer& task_sync, Sender&& sender )
+    {
+        return { task_sync, std::forward<Sender>( sender ) };
+    }
+
+    /// Result of tasksync::synchronized( task_sync ), to adapt a sender with `sender | synchronized( task_sync )`.
+    struct SynchronizedClosure
+    {
+        TaskSynchronizer* task_sync;
+
+        template< class Sender >
+        friend SynchronizedSender<std::decay_t<Sender>> operator|( Sender&& sender, SynchronizedClosure closure )
+        {
+            return { *closure.task_sync, std::forward<Sender>( sender ) };
+        }
+    };
+
+    /** @return A sender adaptor closure: `sender | synchronized( task_sync )` is `synchronized( task_sync, sender )`. */
+    inline SynchronizedClosure synchronized( TaskSynchronizer& task_sync ) { return { &task_sync }; }
+
+    /** Starts work described by senders without waiting for it, and tells when all of it ended, without blocking.
+
+        Each sender passed to spawn() is started as a synchronized task of the scope's synchronizer, so work spawned
+        once it is joined completes with `set_stopped()` without starting. The sender returned by on_empty() completes
+        once no spawned work is pending: an object can chain its asynchronous teardown on it instead of blocking.
+
+        Spawning allocates the operation state of the spawned sender, nothing else. Spawned senders must complete
+        with `set_value()` (values are ignored) or `set_stopped()`: completing with an error terminates, like
+        `std::execution::spawn`.
+
+        The scope must be empty when destroyed.
+    */
+    class AsyncScope
+    {
+        struct EmptyWaiter
+        {
+            EmptyWaiter* next = nullptr;
+            virtual void complete() noexcept = 0;
+
+        protected:
+            ~EmptyWaiter() = default;
+        };
+
+    public:
+        /** @param task_sync Synchronizer of the spawned work, must outlive the scope. */
+        explicit AsyncScope( TaskSynchronizer& task_sync ) : m_task_sync( task_sync ) {}
+
+        ~AsyncScope()
+        {
+            assert( m_pending == 0 && "an async scope must be empty when destroyed" );
+        }
+
+        AsyncScope( const AsyncScope& ) = delete;
+        AsyncScope& operator=( const AsyncScope& ) = delete;
+
+        /** Start the work of `sender`, unless the synchronizer is joined, without waiting for its completion.
+            Exceptions thrown while connecting `sender` are propagated, nothing being spawned.
+        */
+        template< class Sender >
+        void spawn( Sender&& sender )
+        {
+            auto* spawned = new Spawned<std::decay_t<Sender>>{ *this, std::forward<Sender>( sender ) };
+            {
+                // Counted once connected, which can throw, and before starting, which can complete right away.
+                std::scoped_lock lock{ m_mutex };
+                ++m_pending;
+            }
+            spawned->start();
+        }
+
+        /// Sender completing with `set_value()` once the scope has no pending work.
+        class OnEmptySender
+        {
+        public:
+            template< class Receiver >
+            class Operation : EmptyWaiter
+            {
+            public:
+                Operation( AsyncScope& scope, Receiver receiver ) : m_scope( scope ), m_receiver( std::move( receiver ) ) {}
+
+                Operation( const Operation& ) = delete;
+                Operation& operator=( const Operation& ) = delete;
+
+                void start() & noexcept
+                {
+                    if( !m_scope.add_waiter( *this ) )
+                        complete();
+                }
+
+            private:
+                AsyncScope& m_scope;
+                Receiver m_receiver;
+
+                void complete() noexcept override { std::move( m_receiver ).set_value(); }
+            };
+
+            template< class Receiver >
+            Operation<Receiver> connect( Receiver receiver ) const
+            {
+                return Operation<Receiver>{ *m_scope, std::move( receiver ) };
+            }
+
+        private:
+            friend class AsyncScope;
+
+            explicit OnEmptySender( AsyncScope& scope ) : m_scope( &scope ) {}
+
+            AsyncScope* m_scope;
+        };
+
+        /** @return A sender completing once no spawned work is pending, possibly right when started. */
+        OnEmptySender on_empty() { return OnEmptySender{ *this }; }
+
+        /** @return Number of spawned senders which did not complete yet. */
+        int64_t pending() const
+        {
+            std::scoped_lock lock{ m_mutex };
+            return m_pending;
+        }
+
+    private:
+        /// Operation state of a spawned sender, deleting itself on completion.
+        template< class Sender >
+        class Spawned
+        {
+            struct Receiver
+            {
+                Spawned* spawned;
+
+                template< class... Values >
+                void set_value( Values&&... ) && noexcept { spawned->end(); }
+
+                template< class Error >
+                void set_error( Error&& ) && noexcept { std::terminate(); }
+
+                void set_stopped() && noexcept { spawned->end(); }
+            };
+
+        public:
+            Spawned( AsyncScope& scope, Sender sender )
+                : m_scope( scope )
+                , m_operation( SynchronizedSender<Sender>{ scope.m_task_sync, std::move( sender ) }.connect( Receiver{ this } ) )
+            {}
+
+            void start() noexcept { m_operation.start(); }
+
+        private:
+            AsyncScope& m_scope;
+            typename SynchronizedSender<Sender>::template Operation<Receiver> m_operation;
+
+            void end() noexcept
+            {
+                auto& scope = m_scope;
+                delete this;
+                scope.end_one();
+            }
+        };
+
+        TaskSynchronizer& m_task_sync;
+        mutable std::mutex m_mutex;
+        int64_t m_pending = 0; ///< Protected by m_mutex.
+        EmptyWaiter* m_waiters = nullptr; ///< Protected by m_mutex.
+
+        /** @return false if the scope is already empty, in which case the waiter is not added. */
+        bool add_waiter( EmptyWaiter& waiter )
+        {
+            std::scoped_lock lock{ m_mutex };
+            if( m_pending == 0 )
+                return false;
+            waiter.next = m_waiters;
+            m_waiters = &waiter;
+            return true;
+        }
+
+        void end_one() noexcept
+        {
+            EmptyWaiter* waiters = nullptr;
+            {
+                std::scoped_lock lock{ m_mutex };
+                if( --m_pending == 0 )
+                    waiters = std::exchange( m_waiters, nullptr );
+            }
+            // Completing a waiter can destroy this scope: only the list taken out of it is used from now on.
+            while( waiters )
+            {
+                auto* waiter = std::exchange( waiters, waiters->next );
+                waiter->complete();
+            }
+        }
+    };
+
+}
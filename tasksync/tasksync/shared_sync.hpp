@@ -0,0 +1,415 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace tasksync {
+
+    namespace details {
+
+        /// Task counter of a worker process, in shared memory.
+        struct alignas( 64 ) shared_worker_slot
+        {
+            static constexpr int32_t reserved = -1; ///< Pid of a slot being taken or reclaimed.
+
+            std::atomic<int32_t> pid{ 0 }; ///< Zero when free.
+            std::atomic<uint32_t> running{ 0 };
+            std::atomic<uint64_t> start_time{ 0 }; ///< Of the worker process, written before its pid.
+        };
+
+        /// State of a SharedTaskSynchronizer, in shared memory, followed by the slots of the workers.
+        struct alignas( 64 ) shared_sync_state
+        {
+            static constexpr uint32_t expected_magic = 0x7461736b; // "task"
+
+            uint32_t magic = 0; ///< Set to expected_magic once initialized.
+            uint32_t slot_count = 0;
+            std::atomic<uint32_t> join_requested{ 0 };
+            std::atomic<uint32_t> generation{ 0 }; ///< Incremented by reset(): wrappers of previous generations are skipped.
+            std::atomic<uint32_t> exits{ 0 }; ///< Futex word, incremented by the tasks ending during a join.
+            std::atomic<uint32_t> crashed{ 0 }; ///< Number of crashed workers reclaimed.
+
+            shared_worker_slot* slots() { return reinterpret_cast<shared_worker_slot*>( this + 1 ); }
+
+            static std::size_t size( uint32_t slot_count ) { return sizeof( shared_sync_state ) + slot_count * sizeof( shared_worker_slot ); }
+        };
+
+        static_assert( std::atomic<uint32_t>::is_always_lock_free && std::atomic<int32_t>::is_always_lock_free,
+                       "atomics shared between processes must be lock-free" );
+
+        inline std::system_error shared_sync_error( int error, const char* what )
+        {
+            return std::system_error{ error, std::system_category(), what };
+        }
+
+        /** Map the shared memory object `fd` of `size` bytes. Closes `fd`. */
+        inline void* map_shared_sync( int fd, std::size_t size )
+        {
+            void* memory = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+            const auto error = errno;
+            ::close( fd );
+            if( memory == MAP_FAILED )
+                throw shared_sync_error( error, "mmap" );
+            return memory;
+        }
+
+        /** Block until `word` is not `expected` anymore, or `timeout_ms` elapsed, or spuriously. Works across processes. */
+        inline void futex_wait( std::atomic<uint32_t>& word, uint32_t expected, long timeout_ms )
+        {
+            timespec timeout{ timeout_ms / 1000, ( timeout_ms % 1000 ) * 1'000'000 };
+            ::syscall( SYS_futex, reinterpret_cast<uint32_t*>( &word ), FUTEX_WAIT, expected, &timeout, nullptr, 0 );
+        }
+
+        inline void futex_wake_all( std::atomic<uint32_t>& word )
+        {
+            ::syscall( SYS_futex, reinterpret_cast<uint32_t*>( &word ), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0 );
+        }
+
+        /** @return Start time of the process `pid`, in clock ticks since boot, or 0 if it cannot be read.
+            Unlike its pid, it is not reused by a later process.
+        */
+        inline uint64_t process_start_time( int32_t pid )
+        {
+            char path[ 32 ];
+            std::snprintf( path, sizeof( path ), "/proc/%d/stat", static_cast<int>( pid ) );
+            const int fd = ::open( path, O_RDONLY | O_CLOEXEC );
+            if( fd < 0 )
+                return 0;
+            char line[ 1024 ];
+            const auto size = ::read( fd, line, sizeof( line ) - 1 );
+            ::close( fd );
+            if( size <= 0 )
+                return 0;
+            line[ size ] = '\0';
+
+            // The start time is the 22nd field. The command name, 2nd field, may contain spaces and parentheses:
+            // the fields are counted from the last parenthesis.
+            const char* field = std::strrchr( line, ')' );
+            for( int index = 2; field && index < 22; ++index )
+                field = std::strchr( field + 1, ' ' );
+            return field ? std::strtoull( field + 1, nullptr, 10 ) : 0;
+        }
+
+        /** @return true if the process `pid` ended, even if it was not reaped yet, or if its pid was reused by a
+                    process which did not start at `start_time` (not checked if 0).
+        */
+        inline bool process_ended( int32_t pid, uint64_t start_time )
+        {
+            const auto pidfd = static_cast<int>( ::syscall( SYS_pidfd_open, pid, 0 ) );
+            if( pidfd < 0 )
+                return errno == ESRCH;
+            pollfd exited{ pidfd, POLLIN, 0 }; // A process descriptor is readable once the process ended.
+            bool ended = ::poll( &exited, 1, 0 ) > 0;
+            if( !ended && start_time != 0 )
+            {
+                // Read while the descriptor pins the pid. Unreadable (like with hidepid), only the pid is checked.
+                const auto current = process_start_time( pid );
+                ended = current != 0 && current != start_time;
+            }
+            ::close( pidfd );
+            return ended;
+        }
+
+    }
+
+    /** Synchronizer of tasks executed by other processes, which state lives in a POSIX shared memory object.
+
+        The owner, usually the process owning the state the tasks act on, creates the shared memory object; worker
+        processes open it with a SharedTaskWorker and wrap their tasks with SharedTaskWorker::synchronized(), with the
+        same guarantees as TaskSynchronizer::synchronized(): once join_tasks() is called, no task body starts anymore,
+        and join_tasks() waits for the bodies being executed by the workers.
+
+        Each worker counts its running tasks in its own slot of the shared memory, and ending tasks wake up the
+        joining process through a process-shared futex. While waiting, the join checks every
+        `TASKSYNC_SHARED_SYNC_LIVENESS_MS` milliseconds whether the workers with running tasks are alive: the tasks
+        of a crashed worker are not waited for, and its slot is reclaimed. Workers are identified by their pid and
+        start time, so a crashed worker which pid is reused by another process is still found ended.
+
+        Only available on Linux (5.3 or later, for process descriptors).
+    */
+    class SharedTaskSynchronizer
+    {
+    public:
+        /** Create the shared memory object `name`, which must not exist, removed when this synchronizer is destroyed.
+            @param name Name of the POSIX shared memory object, like "/my-service-tasks".
+            @param max_workers Number of SharedTaskWorker which can be attached at the same time.
+            Throws `std::system_error` if the shared memory object cannot be created.
+        */
+        explicit SharedTaskSynchronizer( std::string name, uint32_t max_workers = 64 )
+            : m_name( std::move( name ) )
+            , m_size( details::shared_sync_state::size( max_workers ) )
+        {
+            const int fd = ::shm_open( m_name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600 );
+            if( fd < 0 )
+                throw details::shared_sync_error( errno, "shm_open" );
+            if( ::ftruncate( fd, static_cast<off_t>( m_size ) ) < 0 )
+            {
+                const auto error = errno;
+                ::close( fd );
+                ::shm_unlink( m_name.c_str() );
+                throw details::shared_sync_error( error, "ftruncate" );
+            }
+
+            try
+            {
+                m_state = new( details::map_shared_sync( fd, m_size ) ) details::shared_sync_state{};
+            }
+            catch( ... )
+            {
+                ::shm_unlink( m_name.c_str() );
+                throw;
+            }
+            m_state->slot_count = max_workers;
+            for( uint32_t index = 0; index < max_workers; ++index )
+                new( &m_state->slots()[ index ] ) details::shared_worker_slot{};
+            // Published last: workers opening the shared memory object before are refused.
+            std::atomic_ref{ m_state->magic }.store( details::shared_sync_state::expected_magic, std::memory_order_release );
+        }
+
+        /** Destructor, joining the tasks then removing the shared memory object. Attached workers keep their mapping. */
+        ~SharedTaskSynchronizer()
+        {
+            join_tasks();
+            ::munmap( m_state, m_size );
+            ::shm_unlink( m_name.c_str() );
+        }
+
+        SharedTaskSynchronizer( const SharedTaskSynchronizer& ) = delete;
+        SharedTaskSynchronizer& operator=( const SharedTaskSynchronizer& ) = delete;
+
+        /** @return Name of the shared memory object, to open with a SharedTaskWorker. */
+        const std::string& name() const { return m_name; }
+
+        /** Prevent the tasks of all the workers from starting, then block until the ones running ended, or their
+            worker process ended. @see TaskSynchronizer::join_tasks()
+        */
+        void join_tasks()
+        {
+            auto& state = *m_state;
+            state.join_requested.store( 1, std::memory_order_seq_cst ); // Pairs with SharedTaskWorker::enter().
+            while( true )
+            {
+                const auto exits = state.exits.load( std::memory_order_seq_cst );
+                if( running_tasks_of_live_workers() == 0 )
+                    return;
+                details::futex_wait( state.exits, exits, TASKSYNC_SHARED_SYNC_LIVENESS_MS );
+            }
+        }
+
+        /** Join the tasks then make the synchronizer usable again: tasks wrapped before are still skipped, like with
+            TaskSynchronizer::reset().
+        */
+        void reset()
+        {
+            join_tasks();
+            m_state->generation.fetch_add( 1, std::memory_order_seq_cst ); // Before allowing tasks again.
+            m_state->join_requested.store( 0, std::memory_order_seq_cst );
+        }
+
+        /** @return true if join_tasks() was called and no task is running anymore. */
+        bool is_joined() const
+        {
+            return m_state->join_requested.load( std::memory_order_acquire ) != 0 && running_tasks() == 0;
+        }
+
+        /** @return Number of tasks being executed by the workers, crashed ones included. */
+        std::size_t running_tasks() const
+        {
+            std::size_t running = 0;
+            for( uint32_t index = 0; index < m_state->slot_count; ++index )
+                running += m_state->slots()[ index ].running.load( std::memory_order_seq_cst );
+            return running;
+        }
+
+        /** @return Number of worker processes found ended without destroying their SharedTaskWorker, so far. */
+        std::size_t crashed_workers() const { return m_state->crashed.load( std::memory_order_relaxed ); }
+
+        /** Reclaim the slots of the workers which process ended without detaching.
+            @return Number of slots reclaimed.
+        */
+        std::size_t reclaim_crashed_workers()
+        {
+            std::size_t reclaimed = 0;
+            for( uint32_t index = 0; index < m_state->slot_count; ++index )
+                reclaimed += reclaim_if_crashed( m_state->slots()[ index ] ) ? 1 : 0;
+            return reclaimed;
+        }
+
+    private:
+        std::string m_name;
+        std::size_t m_size;
+        details::shared_sync_state* m_state = nullptr;
+
+        /** @return Number of running tasks, ignoring those of crashed workers, which slots are reclaimed. */
+        std::size_t running_tasks_of_live_workers()
+        {
+            std::size_t running = 0;
+            for( uint32_t index = 0; index < m_state->slot_count; ++index )
+            {
+                auto& slot = m_state->slots()[ index ];
+                const auto slot_running = slot.running.load( std::memory_order_seq_cst );
+                if( slot_running != 0 && !reclaim_if_crashed( slot ) )
+                    running += slot_running;
+            }
+            return running;
+        }
+
+        bool reclaim_if_crashed( details::shared_worker_slot& slot )
+        {
+            auto pid = slot.pid.load( std::memory_order_acquire );
+            if( pid <= 0 || !details::process_ended( pid, slot.start_time.load( std::memory_order_relaxed ) ) )
+                return false;
+            // Taken before resetting its count: the worker may have detached meanwhile, and another one attached to
+            // the slot and entered a task. Attaching workers only take free slots, not reserved ones.
+            if( !slot.pid.compare_exchange_strong( pid, details::shared_worker_slot::reserved, std::memory_order_acquire ) )
+                return false;
+            slot.running.store( 0, std::memory_order_relaxed );
+            slot.pid.store( 0, std::memory_order_release );
+            m_state->crashed.fetch_add( 1, std::memory_order_relaxed );
+            return true;
+        }
+    };
+
+    /** Attachment of the calling process to a SharedTaskSynchronizer created by another one, to execute synchronized tasks.
+
+        Takes a slot of the shared memory until destroyed; a process ending without destroying it is considered as
+        crashed by the owner, which stops waiting for its tasks. The wrappers returned by synchronized() refer to
+        this object, which must outlive them. All the member functions can be called from any thread.
+    */
+    class SharedTaskWorker
+    {
+    public:
+        /** Open the shared memory object of a SharedTaskSynchronizer and take a slot in it.
+            Throws `std::system_error` if it cannot be opened, with `EAGAIN` if it is not initialized yet, or with `ENOSPC`
+            if all its slots are taken.
+        */
+        explicit SharedTaskWorker( const std::string& name )
+        {
+            const int fd = ::shm_open( name.c_str(), O_RDWR | O_CLOEXEC, 0 );
+            if( fd < 0 )
+                throw details::shared_sync_error( errno, "shm_open" );
+            struct stat status{};
+            const int error = ::fstat( fd, &status ) < 0 ? errno : 0;
+            m_size = static_cast<std::size_t>( status.st_size );
+            if( error != 0 || m_size < sizeof( details::shared_sync_state ) )
+            {
+                ::close( fd );
+                throw details::shared_sync_error( error != 0 ? error : EAGAIN, "shared task synchronizer not initialized yet" );
+            }
+            m_state = static_cast<details::shared_sync_state*>( details::map_shared_sync( fd, m_size ) );
+
+            if( std::atomic_ref{ m_state->magic }.load( std::memory_order_acquire ) != details::shared_sync_state::expected_magic
+                || details::shared_sync_state::size( m_state->slot_count ) > m_size )
+            {
+                ::munmap( m_state, m_size );
+                throw details::shared_sync_error( EAGAIN, "shared task synchronizer not initialized yet" );
+            }
+
+            const auto pid = static_cast<int32_t>( ::getpid() );
+            const auto start_time = details::process_start_time( pid );
+            for( uint32_t index = 0; index < m_state->slot_count && !m_slot; ++index )
+            {
+                auto& slot = m_state->slots()[ index ];
+                int32_t free = 0;
+                // Reserved until its start time is written: the owner reads it once it sees the pid.
+                if( slot.pid.compare_exchange_strong( free, details::shared_worker_slot::reserved, std::memory_order_acq_rel ) )
+                {
+                    slot.start_time.store( start_time, std::memory_order_relaxed );
+                    slot.pid.store( pid, std::memory_order_release );
+                    m_slot = &slot;
+                }
+            }
+            if( !m_slot )
+            {
+                ::munmap( m_state, m_size );
+                throw details::shared_sync_error( ENOSPC, "no free slot in the shared task synchronizer" );
+            }
+        }
+
+        /** Destructor, releasing the slot. No task wrapped by this worker can be executing. */
+        ~SharedTaskWorker()
+        {
+            assert( m_slot->running.load() == 0 && "tasks of a shared worker must end before it is destroyed" );
+            m_slot->pid.store( 0, std::memory_order_release );
+            ::munmap( m_state, m_size );
+        }
+
+        SharedTaskWorker( const SharedTaskWorker& ) = delete;
+        SharedTaskWorker& operator=( const SharedTaskWorker& ) = delete;
+
+        /** Wrap the provided callable into a similar callable, synchronized with the SharedTaskSynchronizer of this worker.
+            @return A callable executing `work` unless the synchronizer was joined, or reset, since this call.
+                    The value returned by `work` is ignored.
+            @see TaskSynchronizer::synchronized()
+        */
+        template< class Work >
+        auto synchronized( Work&& work )
+        {
+            return [ this, generation = m_state->generation.load( std::memory_order_acquire ), new_work = std::forward<Work>( work ) ]
+            ( auto&&... args ) mutable
+            {
+                if( !enter( generation ) )
+                    return;
+                details::on_scope_exit _{ [this]{ exit(); } };
+                std::invoke( new_work, std::forward<decltype( args )>( args )... );
+            };
+        }
+
+        /** @return true if the owner requested a join which was not followed by a reset yet. */
+        bool is_join_requested() const { return m_state->join_requested.load( std::memory_order_acquire ) != 0; }
+
+    private:
+        details::shared_sync_state* m_state = nullptr;
+        std::size_t m_size = 0;
+        details::shared_worker_slot* m_slot = nullptr;
+
+        bool enter( uint32_t generation )
+        {
+            // Counted before checking: a join which did not see this task running sees it entering.
+            m_slot->running.fetch_add( 1, std::memory_order_seq_cst );
+            if( m_state->join_requested.load( std::memory_order_seq_cst ) == 0
+                && m_state->generation.load( std::memory_order_seq_cst ) == generation )
+                return true;
+            exit();
+            return false;
+        }
+
+        void exit()
+        {
+            m_slot->running.fetch_sub( 1, std::memory_order_seq_cst );
+            if( m_state->join_requested.load( std::memory_order_seq_cst ) != 0 )
+            {
+                m_state->exits.fetch_add( 1, std::memory_order_seq_cst );
+                details::futex_wake_all( m_state->exits );
+            }
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <utility>
+#include <vector>
+
+namespace tasksync {
+
+    /** Broadcast of events to the callbacks of subscribers, each callback being synchronized with its subscriber's TaskSynchronizer.
+
+        Callbacks are kept with the synchronizer of their subscriber, and removed as soon as a joining function
+        of that synchronizer is called (by the joining thread): joined subscribers cost nothing to emissions,
+        and the callbacks still executing are waited for by the join, like any synchronized task.
+
+        emit() iterates over an immutable snapshot of the callbacks, only copying its pointer: through
+        `std::atomic<std::shared_ptr>` where the standard library provides it (which may not be lock-free), under
+        a mutex otherwise. Connecting and disconnecting copy the callbacks into a new snapshot, so they are linear
+        in the number of callbacks.
+
+        All the member functions can be called from any thread, callbacks being invoked on the emitting thread.
+    */
+    template< class... Args >
+    class Signal
+    {
+    public:
+        Signal() = default;
+
+        /** Destructor, disconnecting all the callbacks. Must not be called while emitting. */
+        ~Signal()
+        {
+            std::shared_ptr<const Subscriptions> released;
+            {
+                std::scoped_lock lock{ m_mutex };
+                released = exchange_snapshot( nullptr );
+            }
+        }
+
+        Signal( const Signal& ) = delete;
+        Signal& operator=( const Signal& ) = delete;
+
+        /** Invoke `callback` on each emission, until `subscriber` is joined or disconnected.
+
+            If `subscriber` is already joined, the callback is dropped.
+            @see TaskSynchronizer::synchronized()
+        */
+        template< class Callback >
+        void connect( TaskSynchronizer& subscriber, Callback&& callback,
+                      details::task_location location = details::task_location::current() )
+        {
+            auto subscription = std::make_shared<Subscription>( subscriber, subscriber.synchronized( std::forward<Callback>( callback ), location ) );
+            // Registered before locking: if the subscriber is already joined, the callback is invoked right away.
+            subscription->on_join.emplace( subscriber.get_stop_token(), PruneOnJoin{ this, subscription.get() } );
+
+            std::shared_ptr<const Subscriptions> released;
+            std::scoped_lock lock{ m_mutex };
+            if( subscription->pruned )
+                return;
+
+            const auto current = load_snapshot();
+            auto next = current ? std::make_shared<Subscriptions>( *current ) : std::make_shared<Subscriptions>();
+            next->push_back( std::move( subscription ) );
+            released = exchange_snapshot( std::move( next ) );
+        }
+
+        /** Remove all the callbacks of `subscriber`. Callbacks being invoked by concurrent emissions can still end. */
+        void disconnect( const TaskSynchronizer& subscriber )
+        {
+            std::shared_ptr<const Subscriptions> released;
+            {
+                std::scoped_lock lock{ m_mutex };
+                released = remove_if( [&]( const Subscription& subscription ) { return subscription.subscriber == &subscriber; } );
+            }
+        }
+
+        /** Invoke the callbacks of the subscribers which are not joined, in the order they were connected. */
+        void emit( Args... args ) const
+        {
+            const auto snapshot = load_snapshot();
+            if( !snapshot )
+                return;
+            for( const auto& subscription : *snapshot )
+                subscription->callback( args... );
+        }
+
+        /** @return Number of connected callbacks. */
+        std::size_t size() const
+        {
+            const auto snapshot = load_snapshot();
+            return snapshot ? snapshot->size() : 0;
+        }
+
+    private:
+        struct Subscription;
+
+        /// Removes a callback when its subscriber is joined.
+        struct PruneOnJoin
+        {
+            Signal* signal;
+            Subscription* subscription;
+
+            void operator()() const noexcept { signal->prune( *subscription ); }
+        };
+
+        struct Subscription
+        {
+            const TaskSynchronizer* subscriber;
+            std::function<void( Args... )> callback;
+            bool pruned = false; ///< Protected by the mutex of the signal.
+            std::optional<std::stop_callback<PruneOnJoin>> on_join;
+
+            template< class Callback >
+            Subscription( const TaskSynchronizer& subscriber, Callback&& callback )
+                : subscriber( &subscriber )
+                , callback( std::forward<Callback>( callback ) )
+            {}
+        };
+
+        using Subscriptions = std::vector<std::shared_ptr<Subscription>>;
+
+        mutable std::mutex m_mutex; ///< Serializes the changes of the snapshot.
+#if defined(__cpp_lib_atomic_shared_ptr)
+        std::atomic<std::shared_ptr<const Subscriptions>> m_snapshot;
+
+        std::shared_ptr<const Subscriptions> load_snapshot() const { return m_snapshot.load( std::memory_order_acquire ); }
+
+        std::shared_ptr<const Subscriptions> exchange_snapshot( std::shared_ptr<const Subscriptions> next )
+        {
+            return m_snapshot.exchange( std::move( next ), std::memory_order_acq_rel );
+        }
+#else
+        mutable std::mutex m_snapshot_mutex; ///< Only held to copy the snapshot pointer.
+        std::shared_ptr<const Subscriptions> m_snapshot;
+
+        std::shared_ptr<const Subscriptions> load_snapshot() const
+        {
+            std::scoped_lock lock{ m_snapshot_mutex };
+            return m_snapshot;
+        }
+
+        std::shared_ptr<const Subscriptions> exchange_snapshot( std::shared_ptr<const Subscriptions> next )
+        {
+            std::scoped_lock lock{ m_snapshot_mutex };
+            return std::exchange( m_snapshot, std::move( next ) );
+        }
+#endif
+
+        /** Replace the snapshot by one without the matching subscriptions. Must be called with the mutex locked.
+            @return The previous snapshot, to be released once unlocked: destroying subscriptions waits for their stop
+                    callbacks, which may be waiting for the mutex.
+        */
+        template< class Predicate >
+        std::shared_ptr<const Subscriptions> remove_if( Predicate&& predicate )
+        {
+            const auto current = load_snapshot();
+            if( !current )
+                return nullptr;
+
+            auto next = std::make_shared<Subscriptions>();
+            next->reserve( current->size() );
+            for( const auto& subscription : *current )
+                if( !predicate( *subscription ) )
+                    next->push_back( subscription );
+
+            if( next->size() == current->size() )
+                return nullptr;
+            return exchange_snapshot( std::move( next ) );
+        }
+
+        void prune( Subscription& pruned )
+        {
+            std::shared_ptr<const Subscriptions> released; // Can hold the last reference to `pruned`, released last.
+            std::scoped_lock lock{ m_mutex };
+            pruned.pruned = true;
+            released = remove_if( [&]( const Subscription& subscription ) { return &subscription == &pruned; } );
+        }
+    };
+
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <tasksync/config.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace tasksync {
+
+    /** Snapshot of the activity counters of a TaskSynchronizer.
+        @see TaskSynchronizer::stats()
+    */
+    struct SynchronizerStats
+    {
+        /// Number of synchronized task bodies that were executed.
+        int64_t executed_tasks = 0;
+
+        /// Number of synchronized tasks invoked while a join was in progress, which were not executed.
+        /// Invocations happening once the synchronizer is destroyed cannot be attributed to it and are not counted.
+        int64_t skipped_tasks = 0;
+
+        /// Highest number of synchronized tasks observed executing at the same time. @see TaskSynchronizer::running_tasks()
+        int64_t peak_running_tasks = 0;
+
+        /// Number of joins performed, one per join_tasks() following construction or reset().
+        int64_t joins = 0;
+
+        /// Cumulative time spent by joins waiting for running tasks to end.
+        std::chrono::nanoseconds join_wait_time{ 0 };
+    };
+
+    /** Accounting of the synchronized callables created by a TaskSynchronizer which were not destroyed yet.
+        @see TaskSynchronizer::wrapper_stats()
+    */
+    struct WrapperStats
+    {
+        /// Number of callables returned by TaskSynchronizer::synchronized(), or copies of them, which still exist.
+        int64_t live_wrappers = 0;
+
+        /// Cumulative size of the callables wrapped by the live wrappers (only their own size, not memory they own).
+        int64_t captured_bytes = 0;
+    };
+
+    namespace details {
+
+        inline constexpr std::size_t cache_line_size = 64;
+
+        /** @return Index identifying the calling thread, assigned in order of first call. */
+        inline std::size_t this_thread_index()
+        {
+            static std::atomic<std::size_t> next_index{ 0 };
+            thread_local const std::size_t index = next_index.fetch_add( 1, std::memory_order_relaxed );
+            return index;
+        }
+
+        inline void update_maximum( std::atomic<int64_t>& maximum, int64_t value )
+        {
+            auto current = maximum.load( std::memory_order_relaxed );
+            while( value > current
+                && !maximum.compare_exchange_weak( current, value, std::memory_order_relaxed ) )
+            {}
+        }
+
+        /** Set of counters split in cache-line sized shards, each thread adding to its own shard,
+            so that they never become a contention point between threads updating them.
+            Reading a counter sums all the shards and can happen from any thread.
+        */
+        template< std::size_t counter_count >
+        class sharded_counters
+        {
+        public:
+
+            void add( std::size_t counter, int64_t value = 1 )
+            {
+                m_shards[ this_thread_index() % m_shards.size() ].counters[ counter ].fetch_add( value, std::memory_order_relaxed );
+            }
+
+            int64_t sum( std::size_t counter ) const
+            {
+                int64_t total = 0;
+                for( const auto& shard : m_shards )
+                    total += shard.counters[ counter ].load( std::memory_order_relaxed );
+                return total;
+            }
+
+        private:
+
+            struct alignas( cache_line_size ) Shard
+            {
+                std::array<std::atomic<int64_t>, counter_count> counters{};
+            };
+
+            std::array<Shard, TASKSYNC_STATS_SHARDS> m_shards;
+        };
+
+        /** Selects one call out of `rate()` for sampling, counting the calls of each shard of threads separately,
+            like sharded_counters. Each sampler owns its countdown: samplers with different rates never skew each other.
+            Threads sharing a shard may lose counts when racing, which only shifts the samples.
+        */
+        class sampling_countdown
+        {
+        public:
+            explicit sampling_countdown( uint32_t one_in ) : m_rate( one_in ) {}
+
+            /** Set how many calls are counted for each one sampled, 0 disables sampling. */
+            void set_rate( uint32_t one_in ) { m_rate.store( one_in, std::memory_order_relaxed ); }
+            uint32_t rate() const { return m_rate.load( std::memory_order_relaxed ); }
+
+            /** @return true if the call is sampled. */
+            bool sample()
+            {
+                const auto rate = this->rate();
+                if( rate == 0 )
+                    return false;
+
+                auto& counted = m_shards[ this_thread_index() % m_shards.size() ].counted;
+                const auto count = counted.load( std::memory_order_relaxed ) + 1;
+                counted.store( count < rate ? count : 0, std::memory_order_relaxed );
+                return count >= rate;
+            }
+
+        private:
+
+            struct alignas( cache_line_size ) Shard
+            {
+                std::atomic<uint32_t> counted{ 0 };
+            };
+
+            std::atomic<uint32_t> m_rate;
+            std::array<Shard, TASKSYNC_STATS_SHARDS> m_shards;
+        };
+
+        /** Activity counters of a TaskSynchronizer.
+
+            Counters updated by task execution are sharded so that they never become a contention point
+            between threads running synchronized tasks.
+        */
+        class synchronizer_counters
+        {
+        public:
+
+            void count_begin_execution( int64_t running_tasks )
+            {
+                m_task_counters.add( executed );
+                update_maximum( m_peak_running_tasks, running_tasks );
+            }
+
+            void count_skipped()
+            {
+                m_task_counters.add( skipped );
+            }
+
+            void count_join( std::chrono::nanoseconds wait_time )
+            {
+                m_joins.fetch_add( 1, std::memory_order_relaxed );
+                m_join_wait_ns.fetch_add( wait_time.count(), std::memory_order_relaxed );
+            }
+
+            SynchronizerStats snapshot() const
+            {
+                SynchronizerStats stats;
+                stats.executed_tasks = m_task_counters.sum( executed );
+                stats.skipped_tasks = m_task_counters.sum( skipped );
+                stats.peak_running_tasks = m_peak_running_tasks.load( std::memory_order_relaxed );
+                stats.joins = m_joins.load( std::memory_order_relaxed );
+                stats.join_wait_time = std::chrono::nanoseconds{ m_join_wait_ns.load( std::memory_order_relaxed ) };
+                return stats;
+            }
+
+        private:
+
+            enum : std::size_t { executed, skipped, task_counter_count };
+            sharded_counters<task_counter_count> m_task_counters;
+
+            alignas( cache_line_size ) std::atomic<int64_t> m_peak_running_tasks{ 0 };
+            std::atomic<int64_t> m_joins{ 0 };
+            std::atomic<int64_t> m_join_wait_ns{ 0 };
+        };
+
+
+        /** Counters of the live synchronized wrappers of a synchronizer.
+
+            Wrappers can outlive their synchronizer, so these counters are shared with them.
+        */
+        class wrapper_accounts
+        {
+        public:
+
+            void count_wrapper( int64_t bytes, int64_t direction )
+            {
+                m_counters.add( live_wrappers, direction );
+                m_counters.add( captured_bytes, direction * bytes );
+            }
+
+            WrapperStats snapshot() const
+            {
+                WrapperStats stats;
+                stats.live_wrappers = m_counters.sum( live_wrappers );
+                stats.captured_bytes = m_counters.sum( captured_bytes );
+                return stats;
+            }
+
+        private:
+            enum : std::size_t { live_wrappers, captured_bytes, counter_count };
+            sharded_counters<counter_count> m_counters;
+        };
+
+        /** Member of a synchronized wrapper counting it as live from construction or copy to destruction. */
+        class wrapper_token
+        {
+        public:
+            wrapper_token( std::shared_ptr<wrapper_accounts> accounts, int64_t bytes )
+                : m_accounts( std::move( accounts ) ), m_bytes( bytes )
+            {
+                m_accounts->count_wrapper( m_bytes, +1 );
+            }
+
+            wrapper_token( const wrapper_token& other )
+                : m_accounts( other.m_accounts ), m_bytes( other.m_bytes )
+            {
+                if( m_accounts )
+                    m_accounts->count_wrapper( m_bytes, +1 );
+            }
+
+            // A moved-from wrapper is empty: the count moves with the callable.
+            wrapper_token( wrapper_token&& other ) noexcept = default;
+
+            wrapper_token& operator=( const wrapper_token& other )
+            {
+                wrapper_token copy{ other };
+                return *this = std::move( copy );
+            }
+
+            wrapper_token& operator=( wrapper_token&& other ) noexcept
+            {
+                release();
+                m_accounts = std::move( other.m_accounts );
+                m_bytes = other.m_bytes;
+                return *this;
+            }
+
+            ~wrapper_token() { release(); }
+
+        private:
+            std::shared_ptr<wrapper_accounts> m_accounts;
+            int64_t m_bytes;
+
+            void release()
+            {
+                if( m_accounts )
+                    m_accounts->count_wrapper( m_bytes, -1 );
+            }
+        };
+
+    }
+}
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace tasksync {
+
+    /// How a submitted task ended. @see TaskHandle
+    enum class TaskOutcome : uint8_t
+    {
+        pending,    ///< Not executed yet.
+        value,      ///< Executed, the result is available.
+        exception,  ///< Executed, and threw.
+        cancelled,  ///< Never executed: skipped because its synchronizer was joined, or dropped by the executor.
+    };
+
+    /// Thrown by TaskHandle::get() when the task was cancelled, thus has no result.
+    class TaskCancelled : public std::exception
+    {
+    public:
+        const char* what() const noexcept override { return "tasksync: the task was cancelled, there is no result"; }
+    };
+
+    namespace details {
+
+        /// Result of a submitted task, shared by its handle and the task given to the executor.
+        template< class T >
+        class submitted_state
+        {
+        public:
+            using value_type = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+            virtual ~submitted_state() = default;
+
+            TaskOutcome outcome() const { return m_outcome.load( std::memory_order_acquire ); }
+
+            void wait() const
+            {
+                auto outcome = m_outcome.load( std::memory_order_acquire );
+                while( outcome == TaskOutcome::pending )
+                {
+                    m_outcome.wait( outcome, std::memory_order_acquire );
+                    outcome = m_outcome.load( std::memory_order_acquire );
+                }
+            }
+
+            value_type& value() { return *m_value; }
+            const std::exception_ptr& exception() const { return m_exception; }
+
+            template< class... Value >
+            void resolve_value( Value&&... value )
+            {
+                m_value.emplace( std::forward<Value>( value )... );
+                resolve( TaskOutcome::value );
+            }
+
+            void resolve_exception( std::exception_ptr exception )
+            {
+                m_exception = std::move( exception );
+                resolve( TaskOutcome::exception );
+            }
+
+            /** Execute the task, the first time only. */
+            void run()
+            {
+                if( m_started.exchange( true, std::memory_order_relaxed ) )
+                    return;
+                execute();
+                if( m_outcome.load( std::memory_order_relaxed ) == TaskOutcome::pending ) // Skipped.
+                    resolve( TaskOutcome::cancelled );
+            }
+
+            void acquire_task() { m_task_references.fetch_add( 1, std::memory_order_relaxed ); acquire(); }
+
+            void release_task()
+            {
+                if( m_task_references.fetch_sub( 1, std::memory_order_acq_rel ) == 1
+                    && !m_started.exchange( true, std::memory_order_relaxed ) ) // Dropped by the executor without executing it.
+                    resolve( TaskOutcome::cancelled );
+                release();
+            }
+
+            void acquire() { m_references.fetch_add( 1, std::memory_order_relaxed ); }
+
+            void release()
+            {
+                if( m_references.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+                    delete this;
+            }
+
+        protected:
+            virtual void execute() = 0;
+
+        private:
+            std::atomic<uint32_t> m_references{ 2 }; ///< The handle and the task.
+            std::atomic<uint32_t> m_task_references{ 1 }; ///< Copies of the task given to the executor.
+            std::atomic<bool> m_started{ false };
+            std::atomic<TaskOutcome> m_outcome{ TaskOutcome::pending };
+            std::optional<value_type> m_value;
+            std::exception_ptr m_exception;
+
+            void resolve( TaskOutcome outcome )
+            {
+                m_outcome.store( outcome, std::memory_order_release );
+                m_outcome.notify_all();
+            }
+        };
+
+        /// The work of a submitted task, in the same allocation as its result.
+        template< class T, class Synched >
+        class submitted_task final : public submitted_state<T>
+        {
+        public:
+            explicit submitted_task( Synched synched ) : m_synched( std::move( synched ) ) {}
+
+        private:
+            Synched m_synched;
+
+            void execute() override { m_synched( static_cast<submitted_state<T>&>( *this ) ); }
+        };
+
+        /// What the executor receives: a reference to the submitted task, small enough to be stored inline by most executors.
+        template< class T >
+        class submitted_task_reference
+        {
+        public:
+            explicit submitted_task_reference( submitted_state<T>* state ) : m_state( state ) {}
+
+            submitted_task_reference( const submitted_task_reference& other ) : m_state( other.m_state )
+            {
+                if( m_state )
+                    m_state->acquire_task();
+            }
+
+            submitted_task_reference( submitted_task_reference&& other ) noexcept : m_state( std::exchange( other.m_state, nullptr ) ) {}
+
+            submitted_task_reference& operator=( submitted_task_reference other ) noexcept
+            {
+                std::swap( m_state, other.m_state );
+                return *this;
+            }
+
+            ~submitted_task_reference()
+            {
+                if( m_state )
+                    m_state->release_task();
+            }
+
+            void operator()() const { m_state->run(); }
+
+        private:
+            submitted_state<T>* m_state;
+        };
+
+    }
+
+    /** Handle to the result of a task submitted with submit(), resolved once the task executed or was cancelled.
+
+        Unlike std::future, a task skipped because its synchronizer was joined, or dropped by its executor without
+        being executed, resolves the handle as cancelled: waiting never hangs.
+    */
+    template< class T >
+    class TaskHandle
+    {
+    public:
+        TaskHandle() = default;
+
+        TaskHandle( TaskHandle&& other ) noexcept : m_state( std::exchange( other.m_state, nullptr ) ) {}
+
+        TaskHandle& operator=( TaskHandle&& other ) noexcept
+        {
+            std::swap( m_state, other.m_state );
+            return *this;
+        }
+
+        ~TaskHandle()
+        {
+            if( m_state )
+                m_state->release();
+        }
+
+        /** @return false if this handle is empty (default constructed or moved from). */
+        bool valid() const { return m_state != nullptr; }
+
+        /** @return How the task ended so far, without waiting. */
+        TaskOutcome outcome() const { assert( valid() ); return m_state->outcome(); }
+
+        bool is_ready() const { return outcome() != TaskOutcome::pending; }
+
+        /** Block until the task executed or was cancelled.
+            @return How the task ended, never TaskOutcome::pending.
+        */
+        TaskOutcome wait() const
+        {
+            assert( valid() );
+            m_state->wait();
+            return m_state->outcome();
+        }
+
+        /** Block until the task executed, then return its result or rethrow its exception.
+            Throws TaskCancelled if the task was cancelled, see wait(). The result is moved out: call once.
+        */
+        T get()
+        {
+            const auto outcome = wait();
+            if( outcome == TaskOutcome::cancelled )
+                throw TaskCancelled{};
+            if( outcome == TaskOutcome::exception )
+                std::rethrow_exception( m_state->exception() );
+            if constexpr( !std::is_void_v<T> )
+                return std::move( m_state->value() );
+        }
+
+        /// Internal, see submit(): takes ownership of a reference to the state.
+        explicit TaskHandle( details::submitted_state<T>* state ) : m_state( state ) {}
+
+    private:
+        details::submitted_state<T>* m_state = nullptr;
+    };
+
+    /** Submit `work` to the executor as a synchronized task, and get a handle to its result.
+
+        The task and its result share a single allocation. The executor (any callable taking a callable with no
+        arguments, see TaskGroup) receives a pointer sized reference to it, which it must invoke at most once.
+        Resolving the handle takes no lock.
+
+        @return A handle resolving with the result of `work`, the exception it threw, or as cancelled if `task_sync`
+                was joined before it started.
+        @see TaskSynchronizer::synchronized()
+    */
+    template< class Executor, class Work >
+    auto submit( Executor&& executor, TaskSynchronizer& task_sync, Work&& work,
+                 details::task_location location = details::task_location::current() )
+    {
+        using Result = std::invoke_result_t<std::decay_t<Work>&>;
+        using State = details::submitted_state<Result>;
+
+        auto synched = task_sync.synchronized( [ work = std::forward<Work>( work ) ]( State& state ) mutable {
+            try
+            {
+                if constexpr( std::is_void_v<Result> )
+                {
+                    std::invoke( work );
+                    state.resolve_value();
+                }
+                else
+                    state.resolve_value( std::invoke( work ) );
+            }
+            catch( ... )
+            {
+                state.resolve_exception( std::current_exception() );
+            }
+        }, location );
+
+        auto* state = new details::submitted_task<Result, decltype( synched )>{ std::move( synched ) };
+        TaskHandle<Result> handle{ state };
+        std::forward<Executor>( executor )( details::submitted_task_reference<Result>{ state } );
+        return handle;
+    }
+
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <utility>
+
+namespace tasksync {
+
+    namespace details {
+
+        /** Number of pending operations which can be waited for, the waiting thread being allowed to destroy it
+            as soon as the wait ends.
+        */
+        class pending_counter
+        {
+        public:
+            void add() { m_pending.fetch_add( 1, std::memory_order_relaxed ); }
+
+            void end()
+            {
+                auto pending = m_pending.load( std::memory_order_relaxed );
+                while( true )
+                {
+                    if( pending > 1 ) // Not the last one: waiting cannot end, no need to lock.
+                    {
+                        if( m_pending.compare_exchange_weak( pending, pending - 1, std::memory_order_acq_rel ) )
+                            return;
+                        continue;
+                    }
+
+                    // The last one only reaches zero while locked: once unlocked, waiting can end and this object be destroyed.
+                    std::scoped_lock lock{ m_mutex };
+                    if( m_pending.compare_exchange_strong( pending, pending - 1, std::memory_order_acq_rel ) )
+                    {
+                        m_all_ended.notify_all();
+                        return;
+                    }
+                }
+            }
+
+            /** Block until all the operations added so far ended. */
+            void wait()
+            {
+                std::unique_lock lock{ m_mutex };
+                m_all_ended.wait( lock, [&]{ return m_pending.load( std::memory_order_acquire ) == 0; } );
+            }
+
+            int64_t count() const { return m_pending.load( std::memory_order_acquire ); }
+
+        private:
+            std::atomic<int64_t> m_pending{ 0 };
+            std::mutex m_mutex;
+            std::condition_variable m_all_ended;
+        };
+
+        /** Operation counted by a pending_counter until end() is called, or until it is destroyed: an operation
+            dropped without being executed, or lost to an exception, does not block the wait. Each copy is counted too.
+        */
+        class pending_operation
+        {
+        public:
+            explicit pending_operation( pending_counter& counter ) : m_counter( &counter ) { counter.add(); }
+
+            pending_operation( const pending_operation& other ) : m_counter( other.m_counter )
+            {
+                if( m_counter )
+                    m_counter->add();
+            }
+
+            pending_operation( pending_operation&& other ) noexcept : m_counter( std::exchange( other.m_counter, nullptr ) ) {}
+
+            pending_operation& operator=( pending_operation other ) noexcept
+            {
+                std::swap( m_counter, other.m_counter );
+                return *this;
+            }
+
+            ~pending_operation() { end(); }
+
+            void end()
+            {
+                if( auto* counter = std::exchange( m_counter, nullptr ) )
+                    counter->end();
+            }
+
+        private:
+            pending_counter* m_counter;
+        };
+
+    }
+
+    /** Fork-join of subtasks synchronized with a TaskSynchronizer: spawn() them onto executors, then wait() for them.
+
+        Subtasks are synchronized tasks: once a joining function of the synchronizer is called, the ones which
+        did not start are skipped and the join waits for the running ones. wait() only waits for the subtasks of
+        this group, whether they execute or are skipped.
+
+        An executor is any callable taking a callable with no arguments, which it must invoke at most once,
+        on any thread (a thread pool's `post()` wrapped in a lambda for example). A subtask the executor drops
+        without invoking it, when shutting down for example, or fails to store by throwing, ends as if skipped.
+        The group only counts its pending subtasks: spawning allocates nothing besides what the executor does
+        to store the subtask.
+
+        The first exception thrown by a subtask is rethrown by wait(), the others are ignored.
+    */
+    class TaskGroup
+    {
+    public:
+        /** @param task_sync Synchronizer of the subtasks, must outlive the group. */
+        explicit TaskGroup( TaskSynchronizer& task_sync ) : m_task_sync( task_sync ) {}
+
+        /** Destructor, waiting for the pending subtasks. Exceptions they threw are dropped. */
+        ~TaskGroup()
+        {
+            m_pending.wait();
+        }
+
+        TaskGroup( const TaskGroup& ) = delete;
+        TaskGroup& operator=( const TaskGroup& ) = delete;
+
+        /** Submit a subtask to the executor, skipped if the synchronizer is joined before it starts.
+            Exceptions thrown by the executor are propagated, the subtask being skipped.
+            @see TaskSynchronizer::synchronized()
+        */
+        template< class Executor, class Work >
+        void spawn( Executor&& executor, Work&& work, details::task_location location = details::task_location::current() )
+        {
+            // The subtask ends when the closure is invoked, or destroyed without being invoked.
+            std::forward<Executor>( executor )( [ this, pending = details::pending_operation{ m_pending },
+                                                  synched_work = m_task_sync.synchronized( std::forward<Work>( work ), location ) ]() mutable {
+                try
+                {
+                    synched_work();
+                }
+                catch( ... )
+                {
+                    capture( std::current_exception() );
+                }
+                pending.end();
+            } );
+        }
+
+        /** Block until all the subtasks spawned so far ended or were skipped, then rethrow the first exception
+            one of them threw, if any. The group can be reused afterwards.
+        */
+        void wait()
+        {
+            m_pending.wait();
+
+            std::exception_ptr exception;
+            {
+                std::scoped_lock lock{ m_exception_mutex };
+                std::swap( exception, m_exception );
+            }
+            if( exception )
+                std::rethrow_exception( exception );
+        }
+
+        /** @return Number of subtasks spawned which did not end nor were skipped yet. */
+        int64_t pending() const { return m_pending.count(); }
+
+    private:
+        TaskSynchronizer& m_task_sync;
+        details::pending_counter m_pending;
+        std::mutex m_exception_mutex;
+        std::exception_ptr m_exception; ///< Protected by m_exception_mutex.
+
+        void capture( std::exception_ptr exception )
+        {
+            std::scoped_lock lock{ m_exception_mutex };
+            if( !m_exception )
+                m_exception = std::move( exception );
+        }
+    };
+
+}
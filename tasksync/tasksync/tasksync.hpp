@@ -1,5 +1,25 @@
 #pragma once
 
+#include <tasksync/config.hpp>
+#include <tasksync/stats.hpp>
+#include <tasksync/histogram.hpp>
+#include <tasksync/probes.hpp>
+#if TASKSYNC_CPU_TIME
+#   include <tasksync/cpu_time.hpp>
+#endif
+#if TASKSYNC_CALL_SITES
+#   include <tasksync/call_sites.hpp>
+#endif
+#if TASKSYNC_RUNNING_REGISTRY
+#   include <tasksync/running_tasks.hpp>
+#endif
+#if TASKSYNC_TRACE
+#   include <tasksync/trace.hpp>
+#endif
+#if TASKSYNC_REGISTRY
+#   include <tasksync/registry.hpp>
+#endif
+
 #include <atomic>
 #include <string>
 #include <cassert>
@@ -7,6 +27,16 @@
 #include <memory>
 #include <functional>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#if TASKSYNC_DETAILS_STOP_TOKEN
+#   include <stop_token>
+#endif
+#include <type_traits>
+#include <utility>
 
 namespace tasksync {
 
@@ -27,8 +57,55 @@ namespace tasksync {
                 }
             }
         };
+
+        /** Invoke `work`, terminating if it throws: the caller needs no unwinding. */
+        template< class Work, class... Args >
+        void invoke_or_terminate( Work& work, Args&&... args ) noexcept
+        {
+            std::invoke( work, std::forward<Args>( args )... );
+        }
+
+        /// Object and parameters of a member function, for TaskSynchronizer::synchronized<&Owner::method>().
+        template< class Method >
+        struct member_function;
+
+        template< class Result, class Object, class... Args >
+        struct member_function<Result ( Object::* )( Args... )> { using object_type = Object; using signature = void( Args... ); };
+
+        template< class Result, class Object, class... Args >
+        struct member_function<Result ( Object::* )( Args... ) const> { using object_type = const Object; using signature = void( Args... ); };
+
+        template< class Result, class Object, class... Args >
+        struct member_function<Result ( Object::* )( Args... ) noexcept> { using object_type = Object; using signature = void( Args... ); };
+
+        template< class Result, class Object, class... Args >
+        struct member_function<Result ( Object::* )( Args... ) const noexcept> { using object_type = const Object; using signature = void( Args... ); };
+
+#if TASKSYNC_CALL_SITES
+        using task_location = std::source_location;
+#else
+        struct task_location // Call sites are not tracked: nothing to capture.
+        {
+            static constexpr task_location current() { return {}; }
+        };
+#endif
     }
 
+    template< class... Steps >
+    class Chain;
+
+    /// What a synchronized task does with an exception thrown by its body. @see TaskSynchronizer::synchronized()
+    enum class ExceptionPolicy : uint8_t
+    {
+        propagate,  ///< Thrown to the caller of the task once its end is notified to the synchronizer.
+        capture,    ///< The first one is kept by the synchronizer and thrown by the next join_tasks(), the next ones are dropped.
+        terminate,  ///< std::terminate() is called.
+    };
+
+    template< auto Method, ExceptionPolicy Policy = ExceptionPolicy::propagate,
+              class Signature = typename details::member_function<decltype( Method )>::signature >
+    class SynchronizedMethod;
+
     /** Synchronize tasks execution in multiple threads with this object's lifetime.
 
         A synchronized callable will never execute outside the lifetime of this object.
@@ -77,6 +154,9 @@ namespace tasksync {
     */
     class TaskSynchronizer
     {
+        template< auto Method, ExceptionPolicy Policy, class Signature >
+        friend class SynchronizedMethod;
+
         auto make_remote_status()
         {
             return std::weak_ptr<Status>{ m_status };
@@ -85,12 +165,12 @@ namespace tasksync {
 
         TaskSynchronizer() = default;
 
-        /** Destructor, joining tasks synchronized with this object.
+        /** Destructor, joining tasks synchronized with this object. An exception captured and not thrown yet is dropped.
             @see join_tasks()
         */
         ~TaskSynchronizer()
         {
-            join_tasks();
+            wait_all_running_tasks();
         }
 
         TaskSynchronizer( const TaskSynchronizer& ) = delete;
@@ -108,31 +188,90 @@ namespace tasksync {
                 - if no joining function have been called yet, notify the synchronizer that the
                     execution begins, then execute the body;
 
+            @tparam Policy What the wrapper does with an exception thrown by `work`, propagated by default.
+                The wrapper is `noexcept` if exceptions are captured or terminate, or if `work` is `noexcept`:
+                the end of the task is then notified without unwinding.
             @param work Any callable object with no arguments. The return value will be ignored.
+            @param location Only used if `TASKSYNC_CALL_SITES` is enabled (`config.tasksync.call_sites`):
+                location of the call, to which the activity of the wrapped task is attributed.
+                @see call_site_stats()
             @return A wrapped version of the provided callable object, adding checks
                 preventing execution of the original callable body if any joining function
                 of this synchronizer was called.
         */
-        template< class Work >
-        auto synchronized( Work&& work )
+        template< ExceptionPolicy Policy = ExceptionPolicy::propagate, class Work >
+        auto synchronized( Work&& work, details::task_location location = details::task_location::current() )
         {
-            return [ this, new_work = std::forward<Work>( work ), remote_status = make_remote_status() ]
+            return synchronized<Policy>( nullptr, std::forward<Work>( work ), location );
+        }
+
+        /** Wrap the provided callable into a similar but synchronized callable, labelled for diagnostics.
+
+            @param label Only used if `TASKSYNC_RUNNING_REGISTRY` or `TASKSYNC_TRACE` is enabled:
+                name describing the task while it runs, must be a string with static storage duration.
+                @see dump_running(), write_chrome_trace()
+            @see synchronized(Work&&)
+        */
+        template< ExceptionPolicy Policy = ExceptionPolicy::propagate, class Work >
+        auto synchronized( [[maybe_unused]] const char* label, Work&& work,
+                           [[maybe_unused]] details::task_location location = details::task_location::current() )
+        {
+            return [ this, new_work = std::forward<Work>( work ), remote_status = make_remote_status()
+#if TASKSYNC_DETAILS_TASK_ORIGIN
+                   , origin = make_task_origin( label, location )
+#endif
+#if TASKSYNC_WRAPPER_ACCOUNTING
+                   , token = details::wrapper_token{ m_wrapper_accounts, sizeof( std::decay_t<Work> ) }
+#endif
+                   ]
             ( auto&&... args ) mutable
+                noexcept( Policy != ExceptionPolicy::propagate || std::is_nothrow_invocable_v<std::decay_t<Work>&, decltype( args )...> )
             {
-                // If status is alive then we know the TaskSynchronizer is alive too.
-                auto status = remote_status.lock();
-                if( status && !status->join_requested ) // Don't add running tasks while join was requested.
-                { // We can use 'this' safely in this scope.
-                    notify_begin_execution();
-                    details::on_scope_exit _{ [&, this]{
-                        status.reset(); // Make sure we are not keeping the TaskSynchronizer waiting
-                        notify_end_execution();
-                    } };
-                    std::invoke( new_work, std::forward<decltype( args )>( args )... );
-                }
+#if !TASKSYNC_DETAILS_TASK_ORIGIN
+                constexpr TaskOrigin origin{};
+#endif
+                execute_synchronized<Policy>( this, remote_status, origin, new_work, std::forward<decltype( args )>( args )... );
             };
         }
 
+        /** Wrap the member function `Method` of `object` into a synchronized callable, the call being bound at compile time.
+
+            Equivalent to `synchronized( [&object]( auto&&... args ) { object.method( args... ); } )`, with a wrapper
+            only holding what tells whether this synchronizer is joined and the address of `object`, and which type
+            exposes the signature of the member function, to be stored in typed slots.
+
+            @tparam Method Pointer to a member function, like `&Owner::on_event`. Its result is ignored.
+            @tparam Policy What the wrapper does with an exception thrown by the member function, propagated by default.
+            @param object Object which member function is called, must outlive the wrapper or this synchronizer.
+            @param location Only used if `TASKSYNC_CALL_SITES` is enabled: location to which the task is attributed.
+            @see synchronized(Work&&), SynchronizedMethod
+        */
+        template< auto Method, ExceptionPolicy Policy = ExceptionPolicy::propagate,
+                  std::enable_if_t<std::is_member_function_pointer_v<decltype( Method )>, int> = 0 >
+        SynchronizedMethod<Method, Policy> synchronized( typename details::member_function<decltype( Method )>::object_type& object,
+                                                         [[maybe_unused]] details::task_location location = details::task_location::current() )
+        {
+            return { make_remote_status(), object
+#if TASKSYNC_DETAILS_TASK_ORIGIN
+                   , make_task_origin( nullptr, location )
+#endif
+#if TASKSYNC_WRAPPER_ACCOUNTING
+                   , details::wrapper_token{ m_wrapper_accounts, sizeof( &object ) }
+#endif
+                   };
+        }
+
+        /** Start a chain of steps executed one after the other as synchronized tasks, stopping between two steps
+            once this synchronizer is joined: `task_sync.chain( parse ).then( validate ).then( persist )`.
+
+            Defined in <tasksync/chain.hpp>, which must be included to use it.
+            @param step First step of the chain, taking the arguments the chain is invoked with.
+            @param location Only used if `TASKSYNC_CALL_SITES` is enabled: location to which the hops of the chain are attributed.
+            @see Chain
+        */
+        template< class Step >
+        Chain<std::decay_t<Step>> chain( Step&& step, details::task_location location = details::task_location::current() );
+
         /** Notify all synchronized tasks and blocks until all already started synchronized tasks are done.
 
             This is a joining function: once it is called, no synchronized task body will be executed again.
@@ -141,24 +280,40 @@ namespace tasksync {
             Only returns once all the executing tasks have finished finishes.
 
             After calling this, is_joined() will return true.
+
+            Throws the first exception captured from tasks synchronized with ExceptionPolicy::capture since the
+            previous join, if any, once all the tasks ended.
         */
         void join_tasks()
         {
             wait_all_running_tasks();
             assert( is_joined() );
+            throw_captured_exception();
         }
 
         /** Join synchronized tasks and reset this object's state to be reusable like if it was just constructed.
 
-            Similar to calling join_tasks() but is_joined() will return false after calling this.
+            Similar to calling join_tasks() but is_joined() will return false after calling this, even if it throws
+            a captured exception.
 
             @see join_tasks()
         */
         void reset()
         {
-            join_tasks();
-            m_status = std::make_shared<Status>();
+            wait_all_running_tasks();
+            assert( is_joined() );
+            TASKSYNC_SCHEDULE_POINT( reset_joined );
+            {
+                auto status = std::make_shared<Status>( *this );
+                std::scoped_lock lock{ m_mutex }; // Read by get_stop_token() and spawn_thread() from other threads.
+                m_status = std::move( status );
+            }
+#if TASKSYNC_REGISTRY
+            m_registration.set_join_state( JoinState::not_joined );
+#endif
+            TASKSYNC_PROBE( reset, this, m_running_tasks.load() );
             assert( !is_joined() );
+            throw_captured_exception();
         }
 
         /** @return true if all synchronized tasks have beeen joined, false otherwise. @see join_tasks(), reset()*/
@@ -167,32 +322,438 @@ namespace tasksync {
         /** @return Number of synchronized tasks which are currently beeing executed. */
         int64_t running_tasks() const { return m_running_tasks; }
 
+#if TASKSYNC_DETAILS_STOP_TOKEN
+        /** @return A token which stop is requested as soon as a joining function of this synchronizer is called,
+                    before waiting for the running tasks.
+
+            Stop callbacks registered on it are invoked by the joining thread: they must not wait for synchronized tasks.
+            If this synchronizer is already joined, the token is already stopped; after reset(), new tokens are
+            bound to the next join.
+            Only available with the C++20 standard library (`std::stop_token`), like spawn_thread().
+        */
+        std::stop_token get_stop_token()
+        {
+            std::scoped_lock lock{ m_mutex };
+            if( !m_status )
+            {
+                std::stop_source joined;
+                joined.request_stop();
+                return joined.get_token();
+            }
+            return get_stop_token_locked();
+        }
+
+        /** Start a thread owned by this synchronizer, executing `body( stop_token )`.
+
+            Joining functions request stop on the token as soon as they are called, then wait for the end of the owned
+            threads along with the running synchronized tasks: the threads of an object stop in parallel with its tasks,
+            instead of being stopped and joined one after the other next to join_tasks().
+
+            The stop token is the one of get_stop_token(), shared by all the threads owned until the next join: besides
+            the thread itself, owning a thread allocates nothing. The thread is joined once its body ended and was
+            destroyed; it then only executes the thread exit of the standard library, and must not have thread-local
+            objects which destructors use objects synchronized by this synchronizer.
+
+            @param body Callable taking a `std::stop_token`, copied or moved into the thread. An exception escaping
+                        it terminates, like with `std::jthread`.
+            @return true if the thread was started, false if this synchronizer is joined already.
+            @see owned_threads()
+        */
+        template< class Body >
+        bool spawn_thread( Body&& body )
+        {
+            std::stop_token stop_token;
+            {
+                std::scoped_lock lock{ m_mutex };
+                if( !m_status )
+                    return false;
+                stop_token = get_stop_token_locked();
+                ++m_owned_threads;
+            }
+
+            try
+            {
+                std::thread{ [ this, stop_token = std::move( stop_token ), owned_body = std::optional<std::decay_t<Body>>{ std::forward<Body>( body ) } ]() mutable {
+                    std::invoke( *owned_body, std::move( stop_token ) );
+                    owned_body.reset(); // Destroyed before the join can end, like the rest of the thread's state.
+                    std::scoped_lock lock{ m_mutex };
+                    --m_owned_threads;
+                    // Notify while locked: once unlocked, joining can end and this object can be destroyed.
+                    TASKSYNC_SCHEDULE_NOTIFY( m_task_end_condition );
+                } }.detach(); // Joined through m_owned_threads: no handle to keep.
+            }
+            catch( ... )
+            {
+                std::scoped_lock lock{ m_mutex };
+                --m_owned_threads;
+                throw;
+            }
+            return true;
+        }
+#endif
+
+        /** @return Number of threads started by spawn_thread() which body did not end yet. */
+        int64_t owned_threads() const
+        {
+            std::scoped_lock lock{ m_mutex };
+            return m_owned_threads;
+        }
+
+#if TASKSYNC_STATS
+        /** @return A snapshot of the activity counters of this synchronizer, can be called from any thread.
+            Only available if `TASKSYNC_STATS` is enabled (`config.tasksync.stats`).
+        */
+        SynchronizerStats stats() const { return m_counters.snapshot(); }
+#endif
+
+#if TASKSYNC_HISTOGRAMS
+        /** @return The distribution of the durations of the sampled synchronized task bodies executed so far.
+            Only available if `TASKSYNC_HISTOGRAMS` is enabled (`config.tasksync.histograms`).
+            @see set_task_duration_sampling()
+        */
+        DurationHistogram task_durations() const { return m_durations.durations(); }
+
+        /** Set how many task executions of this synchronizer are counted for each one which duration is sampled.
+
+            Executions are counted separately by each shard of threads, other synchronizers having their own
+            counts. Executions which are not sampled do not read the clock. 1 samples all the executions, 0 none.
+            The default is `TASKSYNC_HISTOGRAMS_SAMPLING_RATE`.
+        */
+        void set_task_duration_sampling( uint32_t one_in ) { m_durations.set_sampling_rate( one_in ); }
+#endif
+
+#if TASKSYNC_CPU_TIME
+        /** @return CPU time and wall time of the sampled synchronized task bodies executed so far.
+            Only available if `TASKSYNC_CPU_TIME` is enabled (`config.tasksync.cpu_time`).
+            @see set_task_time_sampling()
+        */
+        TaskTimes task_times() const { return m_task_times.times(); }
+
+        /** Set how many task executions of this synchronizer are counted for each one which CPU time and wall time
+            are sampled.
+
+            Executions are counted separately by each shard of threads, other synchronizers having their own
+            counts. Executions which are not sampled do not read the clocks. 1 samples all the executions, 0 none.
+            The default is `TASKSYNC_CPU_TIME_SAMPLING_RATE`.
+        */
+        void set_task_time_sampling( uint32_t one_in ) { m_task_times.set_sampling_rate( one_in ); }
+#endif
+
+#if TASKSYNC_WRAPPER_ACCOUNTING
+        /** @return How many callables returned by synchronized() (or copies of them) still exist, and their captured size,
+                    can be called from any thread.
+            Together with skipped task statistics, this shows how much memory is held by callbacks which will never execute again.
+            Only available if `TASKSYNC_WRAPPER_ACCOUNTING` is enabled (`config.tasksync.wrapper_accounting`).
+        */
+        WrapperStats wrapper_stats() const { return m_wrapper_accounts->snapshot(); }
+#endif
+
+#if TASKSYNC_TRACE
+        /** Select whether the tasks and joins of this synchronizer are recorded in trace events.
+            Only available if `TASKSYNC_TRACE` is enabled (`config.tasksync.trace`).
+            @see write_chrome_trace()
+        */
+        void set_traced( bool traced ) { m_traced.store( traced, std::memory_order_relaxed ); }
+
+        /** @return true if the tasks and joins of this synchronizer are recorded in trace events. @see set_traced() */
+        bool is_traced() const { return m_traced.load( std::memory_order_relaxed ); }
+#endif
+
+#if TASKSYNC_REGISTRY
+        /** Set the name identifying this synchronizer in the metrics, must be a string with static storage duration.
+            Only available if `TASKSYNC_REGISTRY` is enabled (`config.tasksync.registry`).
+            @see write_metrics()
+        */
+        void set_metrics_name( const char* name ) { m_registration.set_name( name ); }
+#endif
+
+#if TASKSYNC_RUNNING_REGISTRY
+        /** Print a line describing each task body of this synchronizer being executed, and its join if one is waiting.
+            Only available if `TASKSYNC_RUNNING_REGISTRY` is enabled (`config.tasksync.running_registry`).
+            @see tasksync::dump_running()
+        */
+        void dump_running( std::ostream& out ) const
+        {
+            const auto now = details::coarse_now();
+            visit_running_tasks( [&]( const RunningTask& task ) {
+                if( task.synchronizer == this )
+                    details::print_running_task_line( out, task, now );
+            } );
+            visit_running_joins( [&]( const RunningJoin& join ) {
+                if( join.synchronizer == this )
+                    details::print_running_join_line( out, join, now );
+            } );
+        }
+#endif
+
     private:
 
         struct Status
         {
+            explicit Status( TaskSynchronizer& owner ) : synchronizer( owner ) {}
+
+            TaskSynchronizer& synchronizer; ///< Alive as long as this status.
             std::atomic<bool> join_requested { false };
+
+#if TASKSYNC_CALL_SITES
+            std::atomic<std::chrono::steady_clock::rep> join_request_time{ 0 };
+
+            void request_join()
+            {
+                join_request_time.store( std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed );
+                join_requested = true;
+            }
+
+            std::chrono::nanoseconds time_since_join_request() const
+            {
+                const std::chrono::steady_clock::duration request_time{ join_request_time.load( std::memory_order_relaxed ) };
+                return std::chrono::steady_clock::now().time_since_epoch() - request_time;
+            }
+#else
+            void request_join() { join_requested = true; }
+#endif
+        };
+
+        /// Where a synchronized task comes from, for the features which need to know.
+        struct TaskOrigin
+        {
+#if TASKSYNC_CALL_SITES
+            details::call_site* call_site = nullptr;
+#endif
+#if TASKSYNC_DETAILS_TASK_LABEL
+            const char* label = nullptr;
+#endif
+        };
+
+        static TaskOrigin make_task_origin( [[maybe_unused]] const char* label, [[maybe_unused]] const details::task_location& location )
+        {
+            TaskOrigin origin;
+#if TASKSYNC_CALL_SITES
+            origin.call_site = &details::call_site_registry::instance().find( location );
+#endif
+#if TASKSYNC_DETAILS_TASK_LABEL
+            origin.label = label;
+#endif
+            return origin;
+        }
+
+        /// Per-execution data kept between the beginning and the end of a synchronized task body.
+        struct ExecutionRecord
+        {
+#if TASKSYNC_HISTOGRAMS
+            details::task_duration_sampler::clock::time_point sample_begin;
+#endif
+#if TASKSYNC_CPU_TIME
+            details::task_time_sampler::sample time_sample;
+#endif
+#if TASKSYNC_RUNNING_REGISTRY
+            details::running_task_slots* running_slots;
+#endif
+#if TASKSYNC_TRACE
+            bool traced;
+#endif
         };
 
         std::atomic<int64_t> m_running_tasks{ 0 };
 
-        std::shared_ptr<Status> m_status = std::make_shared<Status>();
+        std::shared_ptr<Status> m_status = std::make_shared<Status>( *this );
 
-        std::mutex m_mutex;
+        mutable std::mutex m_mutex;
         std::condition_variable m_task_end_condition;
+#if TASKSYNC_DETAILS_STOP_TOKEN
+        std::stop_source m_stop_source{ std::nostopstate }; // Protected by m_mutex.
+#endif
+        int64_t m_owned_threads = 0; // Protected by m_mutex.
+        std::exception_ptr m_captured_exception; // Protected by m_mutex.
+
+#if TASKSYNC_STATS
+        details::synchronizer_counters m_counters;
+#endif
+
+#if TASKSYNC_HISTOGRAMS
+        details::task_duration_sampler m_durations;
+#endif
+
+#if TASKSYNC_CPU_TIME
+        details::task_time_sampler m_task_times;
+#endif
+
+#if TASKSYNC_TRACE
+        std::atomic<bool> m_traced{ false };
+#endif
+
+#if TASKSYNC_WRAPPER_ACCOUNTING
+        const std::shared_ptr<details::wrapper_accounts> m_wrapper_accounts = std::make_shared<details::wrapper_accounts>();
+#endif
+
+#if TASKSYNC_REGISTRY
+        details::registered_synchronizer m_registration{ *this }; // Last, so that it is unregistered first.
+#endif
 
-        void notify_begin_execution()
+        ExecutionRecord notify_begin_execution( [[maybe_unused]] const TaskOrigin& origin )
         {
+#if TASKSYNC_STATS
+            m_counters.count_begin_execution( ++m_running_tasks );
+#else
             ++m_running_tasks;
+#endif
+            TASKSYNC_PROBE( task_begin, this, m_running_tasks.load( std::memory_order_relaxed ) );
+            ExecutionRecord execution;
+#if TASKSYNC_HISTOGRAMS
+            execution.sample_begin = m_durations.sample_begin();
+#endif
+#if TASKSYNC_CPU_TIME
+            execution.time_sample = m_task_times.sample_begin();
+#endif
+#if TASKSYNC_RUNNING_REGISTRY
+            execution.running_slots = &details::running_task_registry::instance().local();
+#   if TASKSYNC_CALL_SITES
+            execution.running_slots->push( this, origin.label, origin.call_site );
+#   else
+            execution.running_slots->push( this, origin.label, nullptr );
+#   endif
+#endif
+#if TASKSYNC_TRACE
+            execution.traced = is_traced();
+            if( execution.traced )
+                details::record_trace_event( details::trace_event_kind::task_begin, this, origin.label );
+#endif
+            return execution;
         }
 
-        void notify_end_execution()
+        void notify_end_execution( [[maybe_unused]] const ExecutionRecord& execution )
         {
+#if TASKSYNC_HISTOGRAMS
+            m_durations.sample_end( execution.sample_begin );
+#endif
+#if TASKSYNC_CPU_TIME
+            m_task_times.sample_end( execution.time_sample );
+#endif
+#if TASKSYNC_RUNNING_REGISTRY
+            execution.running_slots->pop();
+#endif
+#if TASKSYNC_TRACE
+            if( execution.traced )
+                details::record_trace_event( details::trace_event_kind::task_end, this );
+#endif
             {
                 std::unique_lock exit_lock{ m_mutex };
                 --m_running_tasks;
+                TASKSYNC_PROBE( task_end, this, m_running_tasks.load( std::memory_order_relaxed ) );
+                // Notify while locked: once unlocked, joining can end and this object can be destroyed.
+                TASKSYNC_SCHEDULE_NOTIFY( m_task_end_condition );
+            }
+            TASKSYNC_SCHEDULE_POINT( task_ended );
+        }
+
+        /** Body of the synchronized wrappers: execute `work` unless the synchronizer of `remote_status` is joined.
+            @param address Address of the synchronizer, only given to the probes if it is destroyed; null if unknown.
+        */
+        template< ExceptionPolicy Policy, class Work, class... Args >
+        static void execute_synchronized( [[maybe_unused]] const TaskSynchronizer* address, const std::weak_ptr<Status>& remote_status,
+                                          [[maybe_unused]] const TaskOrigin& origin, Work&& work, Args&&... args )
+            noexcept( Policy != ExceptionPolicy::propagate || std::is_nothrow_invocable_v<Work&, Args...> )
+        {
+            // If status is alive then we know the TaskSynchronizer is alive too.
+            auto status = remote_status.lock();
+            TASKSYNC_SCHEDULE_POINT( task_status_locked );
+            if( status && !status->join_requested ) // Don't add running tasks while join was requested.
+            {
+                auto& self = status->synchronizer;
+                const auto execution = self.notify_begin_execution( origin );
+                TASKSYNC_SCHEDULE_POINT( task_began );
+                const auto end_execution = [&]{
+#if TASKSYNC_CALL_SITES
+                    origin.call_site->count_executed();
+                    if( status->join_requested ) // Joining had to wait for us.
+                        origin.call_site->count_time_under_join( status->time_since_join_request() );
+#endif
+                    status.reset(); // Make sure we are not keeping the TaskSynchronizer waiting
+                    TASKSYNC_SCHEDULE_POINT( task_status_released );
+                    self.notify_end_execution( execution );
+                };
+                if constexpr( Policy == ExceptionPolicy::terminate
+                              || std::is_nothrow_invocable_v<Work&, Args...> )
+                { // Nothing to unwind through.
+                    details::invoke_or_terminate( work, std::forward<Args>( args )... );
+                    end_execution();
+                }
+                else if constexpr( Policy == ExceptionPolicy::capture )
+                {
+                    try
+                    {
+                        std::invoke( work, std::forward<Args>( args )... );
+                    }
+                    catch( ... )
+                    {
+                        self.capture_exception( std::current_exception() );
+                    }
+                    end_execution();
+                }
+                else
+                {
+                    details::on_scope_exit _{ end_execution };
+                    std::invoke( work, std::forward<Args>( args )... );
+                }
+            }
+            else
+            {
+                TASKSYNC_PROBE( task_skip, status ? &status->synchronizer : address, status ? status->synchronizer.running_tasks() : -1 );
+#if TASKSYNC_TRACE
+                if( status && status->synchronizer.is_traced() )
+                    details::record_trace_event( details::trace_event_kind::task_skip, &status->synchronizer, origin.label );
+#endif
+#if TASKSYNC_CALL_SITES
+                origin.call_site->count_skipped();
+#endif
+#if TASKSYNC_STATS
+                if( status ) // Joining is waiting for us to release the status: the synchronizer is still alive.
+                    status->synchronizer.m_counters.count_skipped();
+#endif
+                if( status )
+                {
+                    auto& self = status->synchronizer;
+                    self.release_status_while_joining( status );
+                }
+            }
+        }
+
+        /** Keep `exception`, thrown by a task synchronized with ExceptionPolicy::capture, unless one is kept already. */
+        void capture_exception( std::exception_ptr exception ) noexcept
+        {
+            std::scoped_lock lock{ m_mutex };
+            if( !m_captured_exception )
+                m_captured_exception = std::move( exception );
+        }
+
+        void throw_captured_exception()
+        {
+            std::unique_lock lock{ m_mutex };
+            if( auto exception = std::exchange( m_captured_exception, nullptr ) )
+            {
+                lock.unlock();
+                std::rethrow_exception( std::move( exception ) );
+            }
+        }
+
+#if TASKSYNC_DETAILS_STOP_TOKEN
+        std::stop_token get_stop_token_locked()
+        {
+            if( !m_stop_source.stop_possible() ) // Only allocated once asked for.
+                m_stop_source = std::stop_source{};
+            return m_stop_source.get_token();
+        }
+#endif
+
+        /** Release the status of a task skipped because of a join which is waiting for it to be released. */
+        void release_status_while_joining( std::shared_ptr<Status>& status )
+        {
+            {
+                std::unique_lock exit_lock{ m_mutex };
+                status.reset();
+                TASKSYNC_SCHEDULE_NOTIFY( m_task_end_condition );
             }
-            m_task_end_condition.notify_one();
+            TASKSYNC_SCHEDULE_POINT( task_status_released );
         }
 
         void wait_all_running_tasks()
@@ -200,23 +761,124 @@ namespace tasksync {
             if( !m_status )
                 return;
 
+#if TASKSYNC_STATS
+            const auto join_begin = std::chrono::steady_clock::now();
+#endif
+
+#if TASKSYNC_RUNNING_REGISTRY
+            const details::running_join_registry::scope running_join{ this, m_running_tasks };
+#endif
+
+            TASKSYNC_SCHEDULE_POINT( join_begin );
             std::unique_lock exit_lock{ m_mutex };
 
             auto remote_status = make_remote_status();
-            m_status->join_requested = true;
+            m_status->request_join();
             m_status.reset();
+#if TASKSYNC_DETAILS_STOP_TOKEN
+            auto stop_source = std::exchange( m_stop_source, std::stop_source{ std::nostopstate } );
+#endif
+            TASKSYNC_PROBE( join_request, this, m_running_tasks.load() );
+#if TASKSYNC_REGISTRY
+            m_registration.set_join_state( JoinState::joining );
+#endif
+#if TASKSYNC_TRACE
+            const bool traced = is_traced();
+            if( traced )
+                details::record_trace_event( details::trace_event_kind::join_begin, this );
+#endif
+
+#if TASKSYNC_DETAILS_STOP_TOKEN
+            if( stop_source.stop_possible() )
+            { // Stop callbacks may lock their own mutexes, never call them with ours locked.
+                exit_lock.unlock();
+                stop_source.request_stop();
+                exit_lock.lock();
+            }
+#endif
 
-            m_task_end_condition.wait( exit_lock, [&] {
+            const auto all_tasks_ended = [&] {
                 return m_running_tasks == 0
+                    && m_owned_threads == 0
                     && remote_status.expired();
-            } );
-
+            };
+            TASKSYNC_SCHEDULE_WAIT( m_task_end_condition, exit_lock, all_tasks_ended );
+            TASKSYNC_PROBE( join_drain, this, m_running_tasks.load() );
+#if TASKSYNC_REGISTRY
+            m_registration.set_join_state( JoinState::joined );
+#endif
+#if TASKSYNC_TRACE
+            if( traced )
+                details::record_trace_event( details::trace_event_kind::join_end, this );
+#endif
+
+#if TASKSYNC_STATS
+            m_counters.count_join( std::chrono::steady_clock::now() - join_begin );
+#endif
 
         }
 
 
     };
 
+    /** Synchronized callable calling the member function `Method` of an object, returned by
+        TaskSynchronizer::synchronized<&Owner::method>( object ): the call target is known at compile time, and the
+        wrapper only holds what tells whether its synchronizer is joined, and the address of the object.
+
+        Its call operator takes the parameters of the member function, see `signature`, so that it converts to typed
+        slots like `std::function<signature>`. The result of the member function is ignored.
+    */
+    template< auto Method, ExceptionPolicy Policy, class... Args >
+    class SynchronizedMethod<Method, Policy, void( Args... )>
+    {
+        using object_type = typename details::member_function<decltype( Method )>::object_type;
+
+    public:
+        using signature = void( Args... ); ///< Parameters of the member function.
+
+        /** Call the member function unless the synchronizer was joined. @see TaskSynchronizer::synchronized() */
+        void operator()( Args... args ) const
+            noexcept( Policy != ExceptionPolicy::propagate || std::is_nothrow_invocable_v<decltype( Method ), object_type*, Args...> )
+        {
+#if TASKSYNC_DETAILS_TASK_ORIGIN
+            const auto& origin = m_origin;
+#else
+            constexpr TaskSynchronizer::TaskOrigin origin{};
+#endif
+            TaskSynchronizer::execute_synchronized<Policy>( nullptr, m_status, origin, Method, m_object, std::forward<Args>( args )... );
+        }
+
+    private:
+        friend class TaskSynchronizer;
+
+        SynchronizedMethod( std::weak_ptr<TaskSynchronizer::Status> status, object_type& object
+#if TASKSYNC_DETAILS_TASK_ORIGIN
+                          , TaskSynchronizer::TaskOrigin origin
+#endif
+#if TASKSYNC_WRAPPER_ACCOUNTING
+                          , details::wrapper_token token
+#endif
+                          )
+            : m_status( std::move( status ) )
+            , m_object( &object )
+#if TASKSYNC_DETAILS_TASK_ORIGIN
+            , m_origin( origin )
+#endif
+#if TASKSYNC_WRAPPER_ACCOUNTING
+            , m_token( std::move( token ) )
+#endif
+        {}
+
+        std::weak_ptr<TaskSynchronizer::Status> m_status;
+        object_type* m_object;
+#if TASKSYNC_DETAILS_TASK_ORIGIN
+        TaskSynchronizer::TaskOrigin m_origin;
+#endif
+#if TASKSYNC_WRAPPER_ACCOUNTING
+        details::wrapper_token m_token;
+#endif
+    };
+
 }
 
 
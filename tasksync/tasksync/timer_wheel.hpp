@@ -0,0 +1,347 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+
+namespace tasksync {
+
+    /** Delayed and periodic callbacks bound to a TaskSynchronizer, in a hierarchical timer wheel.
+
+        Each timer is synchronized with the synchronizer it was scheduled for: once a joining function
+        of that synchronizer is called, its pending timers are removed from the wheel (in constant time
+        per timer, by the joining thread) and periodic timers stop re-arming. Callbacks already firing
+        are waited for by the join, like any synchronized task.
+
+        Time is counted in ticks of a fixed duration, delays being rounded up to the next tick and measured
+        from the last advance(). Scheduling and cancelling are constant time whatever the number of timers:
+        timers are kept in 4 levels of 256 slots, each level counting in units of 256 ticks of the previous one,
+        and move to lower levels as their expiry gets closer. Timers further than 2^32 ticks are re-inserted
+        until they get in range.
+
+        Timers can be scheduled from any thread; advance() fires the expired ones on the calling thread
+        and must not be called concurrently.
+    */
+    class TimerWheel
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /** @param tick Resolution of the timers.
+            @param start Time of the first tick, advance() being called with later times.
+        */
+        explicit TimerWheel( clock::duration tick = std::chrono::milliseconds{ 1 }, clock::time_point start = clock::now() )
+            : m_tick( tick )
+            , m_start( start )
+        {
+            assert( tick > clock::duration::zero() );
+        }
+
+        /** Destructor, dropping the pending timers without firing them. */
+        ~TimerWheel()
+        {
+            TimerLink dropped;
+            {
+                std::scoped_lock lock{ m_mutex };
+                for( auto& level : m_levels )
+                    for( auto& slot : level )
+                        dropped.splice( slot );
+                // Joins may still cancel them until they are destroyed, but must leave the list alone.
+                for( auto* link = dropped.next; link != &dropped; link = link->next )
+                    static_cast<TimerNode*>( link )->detached = true;
+                dropped.splice( m_cancelled );
+                m_pending = 0;
+            }
+            destroy_all( dropped );
+        }
+
+        TimerWheel( const TimerWheel& ) = delete;
+        TimerWheel& operator=( const TimerWheel& ) = delete;
+
+        /** Call `work` once, after `delay`, unless `task_sync` is joined before. @see TaskSynchronizer::synchronized() */
+        template< class Work >
+        void schedule_after( TaskSynchronizer& task_sync, clock::duration delay, Work&& work,
+                             details::task_location location = details::task_location::current() )
+        {
+            schedule( task_sync, to_ticks( delay ), 0, std::forward<Work>( work ), location );
+        }
+
+        /** Call `work` every `period`, the first time after one period, until `task_sync` is joined.
+            @see TaskSynchronizer::synchronized()
+        */
+        template< class Work >
+        void schedule_every( TaskSynchronizer& task_sync, clock::duration period, Work&& work,
+                             details::task_location location = details::task_location::current() )
+        {
+            const auto period_ticks = to_ticks( period );
+            schedule( task_sync, period_ticks, period_ticks, std::forward<Work>( work ), location );
+        }
+
+        /** Fire, on the calling thread, the timers which expired at `now`.
+
+            Periodic timers fire at most once per call: if more than one period elapsed, they are re-armed one
+            period after `now` instead of catching up.
+            @return Number of fired timers, including the ones which bodies were skipped because of a join.
+        */
+        std::size_t advance( clock::time_point now = clock::now() )
+        {
+            TimerLink due;
+            TimerLink cancelled;
+            int64_t fired_tick = 0;
+            {
+                std::scoped_lock lock{ m_mutex };
+                cancelled.splice( m_cancelled );
+
+                const auto target_tick = ( now - m_start ) / m_tick;
+                while( m_current_tick < target_tick )
+                {
+                    if( m_pending == 0 )
+                    {
+                        m_current_tick = target_tick;
+                        break;
+                    }
+                    ++m_current_tick;
+                    cascade();
+                    auto& slot = m_levels[ 0 ][ slot_index( m_current_tick, 0 ) ];
+                    while( !slot.empty() )
+                    {
+                        auto* node = slot.front();
+                        node->unlink();
+                        --m_pending;
+                        node->detached = true;
+                        due.push_back( *node );
+                    }
+                }
+                fired_tick = m_current_tick;
+            }
+            destroy_all( cancelled );
+
+            std::size_t fired = 0;
+            while( !due.empty() )
+            {
+                auto* node = due.front();
+                node->unlink();
+                node->fire();
+                ++fired;
+
+                bool rearmed = false;
+                {
+                    std::scoped_lock lock{ m_mutex };
+                    node->detached = false;
+                    if( node->period > 0 && !node->cancelled )
+                    {
+                        node->expiry = fired_tick + node->period;
+                        insert( *node );
+                        rearmed = true;
+                    }
+                }
+                if( !rearmed )
+                    delete node;
+            }
+            return fired;
+        }
+
+        /** @return Number of timers waiting to fire. */
+        std::size_t pending() const
+        {
+            std::scoped_lock lock{ m_mutex };
+            return m_pending;
+        }
+
+    private:
+        static constexpr int level_count = 4;
+        static constexpr int slot_bits = 8;
+        static constexpr int64_t slot_count = int64_t{ 1 } << slot_bits;
+        static constexpr int64_t max_ticks = ( int64_t{ 1 } << ( slot_bits * level_count ) ) - 1;
+
+        struct TimerNode;
+
+        /// Links of a circular intrusive list, a standalone link being the head of the list.
+        struct TimerLink
+        {
+            TimerLink* previous = this;
+            TimerLink* next = this;
+
+            TimerLink() = default;
+            TimerLink( const TimerLink& ) = delete;
+            TimerLink& operator=( const TimerLink& ) = delete;
+
+            bool empty() const { return next == this; }
+
+            TimerNode* front();
+
+            void push_back( TimerLink& link )
+            {
+                link.previous = previous;
+                link.next = this;
+                previous->next = &link;
+                previous = &link;
+            }
+
+            void unlink()
+            {
+                previous->next = next;
+                next->previous = previous;
+                previous = next = this;
+            }
+
+            /** Move all the elements of another list at the end of this one. */
+            void splice( TimerLink& other )
+            {
+                if( other.empty() )
+                    return;
+                other.next->previous = previous;
+                other.previous->next = this;
+                previous->next = other.next;
+                previous = other.previous;
+                other.previous = other.next = &other;
+            }
+        };
+
+        /// Removes a timer from the wheel when its synchronizer is joined.
+        struct CancelOnJoin
+        {
+            TimerWheel* wheel;
+            TimerNode* node;
+
+            void operator()() const noexcept { wheel->cancel( *node ); }
+        };
+
+        /// A scheduled timer. The fields are protected by the mutex of the wheel.
+        struct TimerNode : TimerLink
+        {
+            int64_t expiry = 0;
+            int64_t period = 0; ///< In ticks, zero for timers firing once.
+            bool detached = false; ///< Out of the wheel, owned by advance() or the destructor.
+            bool cancelled = false;
+            std::optional<std::stop_callback<CancelOnJoin>> on_join;
+
+            virtual ~TimerNode() = default;
+            virtual void fire() = 0;
+        };
+
+        template< class Wrapped >
+        struct Timer final : TimerNode
+        {
+            Wrapped wrapped;
+
+            explicit Timer( Wrapped&& wrapped ) : wrapped( std::move( wrapped ) ) {}
+
+            void fire() override { wrapped(); }
+        };
+
+        const clock::duration m_tick;
+        const clock::time_point m_start;
+
+        mutable std::mutex m_mutex;
+        int64_t m_current_tick = 0;
+        std::size_t m_pending = 0;
+        std::array<std::array<TimerLink, slot_count>, level_count> m_levels;
+        TimerLink m_cancelled; ///< Timers removed by joins, destroyed by the next advance().
+
+        int64_t to_ticks( clock::duration duration ) const
+        {
+            const auto ticks = ( duration + m_tick - clock::duration{ 1 } ) / m_tick;
+            return ticks < 1 ? 1 : ticks;
+        }
+
+        static std::size_t slot_index( int64_t tick, int level )
+        {
+            return static_cast<std::size_t>( ( tick >> ( slot_bits * level ) ) & ( slot_count - 1 ) );
+        }
+
+        template< class Work >
+        void schedule( TaskSynchronizer& task_sync, int64_t delay_ticks, int64_t period_ticks, Work&& work,
+                       const details::task_location& location )
+        {
+            auto wrapped = task_sync.synchronized( std::forward<Work>( work ), location );
+            auto* node = new Timer<decltype( wrapped )>{ std::move( wrapped ) };
+            node->period = period_ticks;
+            // Registered before locking: if the synchronizer is already joined, the callback is invoked right away.
+            node->on_join.emplace( task_sync.get_stop_token(), CancelOnJoin{ this, node } );
+
+            {
+                std::scoped_lock lock{ m_mutex };
+                if( !node->cancelled )
+                {
+                    node->expiry = m_current_tick + delay_ticks;
+                    insert( *node );
+                    return;
+                }
+            }
+            delete node;
+        }
+
+        void insert( TimerNode& node )
+        {
+            const auto delta = node.expiry - m_current_tick;
+            ++m_pending;
+            for( int level = 0; level < level_count; ++level )
+            {
+                if( delta < ( int64_t{ 1 } << ( slot_bits * ( level + 1 ) ) ) )
+                {
+                    m_levels[ level ][ slot_index( node.expiry, level ) ].push_back( node );
+                    return;
+                }
+            }
+            // Out of range: parked at the farthest slot, re-inserted from there.
+            const auto parking_tick = m_current_tick + max_ticks;
+            m_levels[ level_count - 1 ][ slot_index( parking_tick, level_count - 1 ) ].push_back( node );
+        }
+
+        /** Move the timers of the higher levels slots which begin at the current tick to lower levels. */
+        void cascade()
+        {
+            int levels = 0;
+            while( levels + 1 < level_count && slot_index( m_current_tick, levels ) == 0 )
+                ++levels;
+
+            for( int level = levels; level >= 1; --level )
+            {
+                TimerLink moved;
+                moved.splice( m_levels[ level ][ slot_index( m_current_tick, level ) ] );
+                while( !moved.empty() )
+                {
+                    auto* node = moved.front();
+                    node->unlink();
+                    --m_pending;
+                    insert( *node );
+                }
+            }
+        }
+
+        void cancel( TimerNode& node )
+        {
+            std::scoped_lock lock{ m_mutex };
+            node.cancelled = true;
+            if( node.detached || node.empty() ) // Being fired, dropped or not inserted yet: the owner deletes it.
+                return;
+            node.unlink();
+            --m_pending;
+            m_cancelled.push_back( node );
+        }
+
+        /** Delete the timers of a list, without holding the lock: their stop callbacks may be running and need it. */
+        static void destroy_all( TimerLink& list )
+        {
+            while( !list.empty() )
+            {
+                auto* node = list.front();
+                node->unlink();
+                delete node;
+            }
+        }
+    };
+
+    inline TimerWheel::TimerNode* TimerWheel::TimerLink::front() { return static_cast<TimerNode*>( next ); }
+
+}
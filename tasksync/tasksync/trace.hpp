@@ -0,0 +1,196 @@
+#pragma once
+
+#include <tasksync/config.hpp>
+#include <tasksync/per_thread.hpp>
+#include <tasksync/stats.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+namespace tasksync {
+
+    namespace details {
+
+        enum class trace_event_kind : uint32_t
+        {
+            task_begin,
+            task_end,
+            task_skip,
+            join_begin,
+            join_end,
+        };
+
+        struct trace_event
+        {
+            trace_event_kind kind;
+            uint32_t thread;
+            int64_t timestamp_ns;
+            const void* synchronizer;
+            const char* name;
+        };
+
+        /** Ring of the last trace events recorded by one thread.
+
+            Only the owning thread writes, without locking nor allocating. Each field is a relaxed atomic
+            so that readers can copy events while they are written, then discard the ones which were
+            overwritten meanwhile by checking the write position again.
+        */
+        class trace_buffer
+        {
+        public:
+            static constexpr std::size_t capacity = TASKSYNC_TRACE_BUFFER_EVENTS;
+
+            void attach_to_this_thread()
+            {
+                m_thread.store( static_cast<uint32_t>( this_thread_index() ), std::memory_order_relaxed );
+            }
+
+            void record( trace_event_kind kind, const void* synchronizer, const char* name )
+            {
+                const auto position = m_written.load( std::memory_order_relaxed );
+                auto& slot = m_events[ position % capacity ];
+                slot.kind.store( kind, std::memory_order_relaxed );
+                slot.thread.store( m_thread.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+                slot.timestamp_ns.store( std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch() ).count(), std::memory_order_relaxed );
+                slot.synchronizer.store( synchronizer, std::memory_order_relaxed );
+                slot.name.store( name, std::memory_order_relaxed );
+                m_written.store( position + 1, std::memory_order_release );
+            }
+
+            /** Append the events of this buffer, oldest first, to `events`. */
+            void copy_to( std::vector<trace_event>& events ) const
+            {
+                const auto written = m_written.load( std::memory_order_acquire );
+                const auto first = written > capacity ? written - capacity : 0;
+                const auto copied_begin = events.size();
+
+                for( auto position = first; position < written; ++position )
+                {
+                    const auto& slot = m_events[ position % capacity ];
+                    events.push_back( { slot.kind.load( std::memory_order_relaxed ),
+                                        slot.thread.load( std::memory_order_relaxed ),
+                                        slot.timestamp_ns.load( std::memory_order_relaxed ),
+                                        slot.synchronizer.load( std::memory_order_relaxed ),
+                                        slot.name.load( std::memory_order_relaxed ) } );
+                }
+
+                // Drop the events which may have been overwritten while copying.
+                std::atomic_thread_fence( std::memory_order_acquire );
+                const auto written_after = m_written.load( std::memory_order_relaxed );
+                const auto overwritten = written_after > capacity ? written_after - capacity : 0;
+                if( overwritten > first )
+                {
+                    const auto dropped = std::min<std::size_t>( overwritten - first, events.size() - copied_begin );
+                    events.erase( events.begin() + copied_begin, events.begin() + copied_begin + dropped );
+                }
+            }
+
+        private:
+
+            struct Slot
+            {
+                std::atomic<trace_event_kind> kind{ trace_event_kind::task_begin };
+                std::atomic<uint32_t> thread{ 0 };
+                std::atomic<int64_t> timestamp_ns{ 0 };
+                std::atomic<const void*> synchronizer{ nullptr };
+                std::atomic<const char*> name{ nullptr };
+            };
+
+            std::array<Slot, capacity> m_events;
+            std::atomic<std::size_t> m_written{ 0 };
+            std::atomic<uint32_t> m_thread{ 0 };
+        };
+
+        /// Trace buffers of all the threads.
+        using trace_registry = per_thread_registry<trace_buffer>;
+
+        inline void record_trace_event( trace_event_kind kind, const void* synchronizer, const char* name = nullptr )
+        {
+            trace_registry::instance().local().record( kind, synchronizer, name );
+        }
+
+        inline void write_json_string( std::ostream& out, const char* text )
+        {
+            out << '"';
+            for( ; *text; ++text )
+            {
+                const auto character = static_cast<unsigned char>( *text );
+                if( character == '"' || character == '\\' )
+                    out << '\\' << *text;
+                else if( character < 0x20 )
+                {
+                    char escaped[ 8 ];
+                    std::snprintf( escaped, sizeof( escaped ), "\\u%04x", character );
+                    out << escaped;
+                }
+                else
+                    out << *text;
+            }
+            out << '"';
+        }
+
+        inline void write_trace_event( std::ostream& out, const trace_event& event )
+        {
+            const char* name = "task";
+            const char* phase = "B";
+            switch( event.kind )
+            {
+            case trace_event_kind::task_begin: break;
+            case trace_event_kind::task_end:   phase = "E"; break;
+            case trace_event_kind::task_skip:  name = "skip"; phase = "i"; break;
+            case trace_event_kind::join_begin: name = "join"; break;
+            case trace_event_kind::join_end:   name = "join"; phase = "E"; break;
+            }
+            if( event.name )
+                name = event.name;
+
+            char timestamp[ 32 ];
+            std::snprintf( timestamp, sizeof( timestamp ), "%lld.%03lld",
+                           static_cast<long long>( event.timestamp_ns / 1000 ), static_cast<long long>( event.timestamp_ns % 1000 ) );
+
+            out << "{\"name\":";
+            write_json_string( out, name );
+            out << ",\"cat\":\"tasksync\",\"ph\":\"" << phase << '"'
+                << ",\"ts\":" << timestamp
+                << ",\"pid\":1,\"tid\":" << event.thread;
+            if( event.kind == trace_event_kind::task_skip )
+                out << ",\"s\":\"t\"";
+            out << ",\"args\":{\"synchronizer\":\"" << event.synchronizer << "\"}}";
+        }
+    }
+
+    /** Write the trace events recorded so far by the traced synchronizers, in the Chrome trace event JSON format
+        (loadable in chrome://tracing or https://ui.perfetto.dev).
+
+        Tasks and joins appear as spans on the timeline of the thread executing them, skipped tasks as instant events.
+        Each thread keeps its last `TASKSYNC_TRACE_BUFFER_EVENTS` events, older ones are lost.
+        Only available if `TASKSYNC_TRACE` is enabled (`config.tasksync.trace`).
+        @see TaskSynchronizer::set_traced()
+    */
+    inline void write_chrome_trace( std::ostream& out )
+    {
+        std::vector<details::trace_event> events;
+        details::trace_registry::instance().visit_all( [&]( const details::trace_buffer& buffer ) {
+            buffer.copy_to( events );
+        } );
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        const char* separator = "\n";
+        for( const auto& event : events )
+        {
+            out << separator;
+            details::write_trace_event( out, event );
+            separator = ",\n";
+        }
+        out << "\n]}\n";
+    }
+
+}
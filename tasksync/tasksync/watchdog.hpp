@@ -0,0 +1,175 @@
+#pragma once
+
+#include <tasksync/tasksync.hpp>
+
+#if !TASKSYNC_WATCHDOG
+#   error "tasksync/watchdog.hpp requires TASKSYNC_WATCHDOG to be enabled (config.tasksync.watchdog)"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace tasksync {
+
+    /** Description of a synchronized task or join running for longer than the Watchdog's threshold. */
+    struct WatchdogReport
+    {
+        enum class Kind { slow_task, slow_join };
+
+        Kind kind = Kind::slow_task;
+
+        /// Synchronizer of the task or being joined.
+        const TaskSynchronizer* synchronizer = nullptr;
+
+        /// Thread executing the task or waiting for the join.
+        std::thread::id thread;
+
+        /// When the task or join began.
+        std::chrono::steady_clock::time_point start;
+
+        /// How long the task or join was running when detected.
+        std::chrono::nanoseconds elapsed{ 0 };
+
+        /// Slow tasks only: label provided to TaskSynchronizer::synchronized(), if any.
+        const char* label = nullptr;
+
+#if TASKSYNC_CALL_SITES
+        /// Slow tasks only: location of the TaskSynchronizer::synchronized() call which wrapped the task.
+        std::source_location location;
+#endif
+
+        /// Slow joins only: number of tasks the join was waiting for.
+        int64_t running_tasks = 0;
+    };
+
+    /** Periodically scans the running synchronized tasks and joins of all synchronizers, and reports
+        the ones running for longer than a threshold through a callback.
+
+        Each slow task or join is reported once. Start times use a coarse clock, so durations are
+        precise to a few milliseconds. The callback is called from the watchdog's own thread,
+        which is stopped and joined on destruction.
+
+        Only available if `TASKSYNC_WATCHDOG` is enabled (`config.tasksync.watchdog`).
+    */
+    class Watchdog
+    {
+    public:
+        using Callback = std::function<void( const WatchdogReport& )>;
+
+        /** Start the watchdog thread.
+            @param period Time between two scans.
+            @param slow_task_threshold Tasks running for longer than this are reported.
+            @param slow_join_threshold Joins waiting for longer than this are reported.
+            @param callback Called with each report.
+        */
+        Watchdog( std::chrono::milliseconds period,
+                  std::chrono::milliseconds slow_task_threshold,
+                  std::chrono::milliseconds slow_join_threshold,
+                  Callback callback )
+            : m_period( period )
+            , m_slow_task_threshold( slow_task_threshold )
+            , m_slow_join_threshold( slow_join_threshold )
+            , m_callback( std::move( callback ) )
+            , m_thread( [this]{ run(); } )
+        {
+        }
+
+        ~Watchdog()
+        {
+            {
+                std::scoped_lock lock{ m_mutex };
+                m_stop_requested = true;
+            }
+            m_stop_condition.notify_one();
+            m_thread.join();
+        }
+
+        Watchdog( const Watchdog& ) = delete;
+        Watchdog& operator=( const Watchdog& ) = delete;
+
+        Watchdog( Watchdog&& ) noexcept = delete;
+        Watchdog& operator=( Watchdog&& ) noexcept = delete;
+
+    private:
+
+        using ReportKey = std::tuple<WatchdogReport::Kind, const TaskSynchronizer*, std::thread::id, std::chrono::steady_clock::time_point>;
+
+        const std::chrono::milliseconds m_period;
+        const std::chrono::milliseconds m_slow_task_threshold;
+        const std::chrono::milliseconds m_slow_join_threshold;
+        const Callback m_callback;
+
+        std::mutex m_mutex;
+        std::condition_variable m_stop_condition;
+        bool m_stop_requested = false;
+
+        std::vector<ReportKey> m_reported; // Only used by the watchdog thread.
+
+        std::thread m_thread; // Last, so that it starts once everything else is constructed.
+
+        void run()
+        {
+            std::unique_lock lock{ m_mutex };
+            while( !m_stop_condition.wait_for( lock, m_period, [&]{ return m_stop_requested; } ) )
+            {
+                lock.unlock();
+                scan();
+                lock.lock();
+            }
+        }
+
+        void scan()
+        {
+            const auto now = details::coarse_now();
+            std::vector<WatchdogReport> reports;
+
+            visit_running_tasks( [&]( const RunningTask& task ) {
+                if( now - task.start < m_slow_task_threshold )
+                    return;
+                WatchdogReport report;
+                report.kind = WatchdogReport::Kind::slow_task;
+                report.synchronizer = task.synchronizer;
+                report.thread = task.thread;
+                report.start = task.start;
+                report.elapsed = now - task.start;
+                report.label = task.label;
+#if TASKSYNC_CALL_SITES
+                report.location = task.location;
+#endif
+                reports.push_back( report );
+            } );
+
+            // Don't call back while the joins are locked: the callback could join.
+            visit_running_joins( [&]( const RunningJoin& join ) {
+                if( now - join.start < m_slow_join_threshold )
+                    return;
+                WatchdogReport report;
+                report.kind = WatchdogReport::Kind::slow_join;
+                report.synchronizer = join.synchronizer;
+                report.thread = join.thread;
+                report.start = join.start;
+                report.elapsed = now - join.start;
+                report.running_tasks = join.running_tasks;
+                reports.push_back( report );
+            } );
+
+            std::vector<ReportKey> still_running;
+            still_running.reserve( reports.size() );
+            for( const auto& report : reports )
+            {
+                const ReportKey key{ report.kind, report.synchronizer, report.thread, report.start };
+                still_running.push_back( key );
+                if( std::find( m_reported.begin(), m_reported.end(), key ) == m_reported.end() )
+                    m_callback( report );
+            }
+            m_reported = std::move( still_running );
+        }
+    };
+
+}